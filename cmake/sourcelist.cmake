@@ -3,11 +3,28 @@ set(SOURCES
 	src/main.cpp
 	src/Hooks.h
 	src/Hooks.cpp
+	src/FormCache.h
+	src/FormCache.cpp
+	src/LoadProfile.h
+	src/LoadProfile.cpp
+	src/MemoryTracking.h
+	src/MemoryTracking.cpp
+	src/PenetrationCache.h
+	src/PenetrationCache.cpp
 	src/PenetrationConfig.h
 	src/PenetrationConfig.cpp
+	src/PenetrationSnapshot.h
+	src/PenetrationTask.h
+	src/PenetrationTask.cpp
+	src/PendingShooters.h
+	src/PendingShooters.cpp
 	src/PenetrationSystem.h
 	src/PenetrationSystem.cpp
+	src/Scheduler.h
+	src/Scheduler.cpp
 	src/Utils.h
 	src/Utils.cpp
+	src/WorkerPool.h
+	src/WorkerPool.cpp
 	src/SimpleIni.h
 )
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "FormCache.h"
+
+#include "MemoryTracking.h"
+
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace Penetration::FormCache
+{
+	namespace
+	{
+		constexpr std::uint32_t kMagic = 0x43465350;  // "PSFC"
+		constexpr std::uint32_t kVersion = 2;
+		constexpr std::uint64_t kFnvOffset = 0xCBF29CE484222325ull;
+		constexpr std::uint64_t kFnvPrime = 0x100000001B3ull;
+
+		// Written field by field: the in-memory layouts carry padding, which would otherwise reach
+		// the file as uninitialised bytes.
+		struct Header
+		{
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint64_t loadOrderHash;
+			std::uint32_t count;
+		};
+
+		struct Record
+		{
+			std::uint64_t key;
+			std::uint32_t formID;
+		};
+
+		struct Cache
+		{
+			Memory::UnorderedMap<Memory::Tag::kConfig, std::uint64_t, std::uint32_t> entries;
+			std::uint64_t loadOrderHash{ 0 };
+			bool dirty{ false };
+			std::mutex lock;
+		};
+
+		Cache g_cache;
+
+		template <class T>
+		void WriteField(std::ofstream& file, const T& value)
+		{
+			file.write(reinterpret_cast<const char*>(std::addressof(value)), sizeof(value));
+		}
+
+		template <class T>
+		void ReadField(std::ifstream& file, T& value)
+		{
+			file.read(reinterpret_cast<char*>(std::addressof(value)), sizeof(value));
+		}
+
+		void WriteHeader(std::ofstream& file, const Header& header)
+		{
+			WriteField(file, header.magic);
+			WriteField(file, header.version);
+			WriteField(file, header.loadOrderHash);
+			WriteField(file, header.count);
+		}
+
+		void ReadHeader(std::ifstream& file, Header& header)
+		{
+			ReadField(file, header.magic);
+			ReadField(file, header.version);
+			ReadField(file, header.loadOrderHash);
+			ReadField(file, header.count);
+		}
+
+		void WriteRecord(std::ofstream& file, const Record& record)
+		{
+			WriteField(file, record.key);
+			WriteField(file, record.formID);
+		}
+
+		void ReadRecord(std::ifstream& file, Record& record)
+		{
+			ReadField(file, record.key);
+			ReadField(file, record.formID);
+		}
+
+		std::uint64_t Mix(std::uint64_t hash, std::uint8_t byte) noexcept
+		{
+			return (hash ^ byte) * kFnvPrime;
+		}
+
+		std::uint64_t MixName(std::uint64_t hash, std::string_view name) noexcept
+		{
+			for (const char ch : name) {
+				hash = Mix(hash, static_cast<std::uint8_t>(std::tolower(static_cast<unsigned char>(ch))));
+			}
+			return Mix(hash, 0);
+		}
+
+		std::uint64_t MixValue(std::uint64_t hash, std::uint32_t value) noexcept
+		{
+			for (int shift = 0; shift < 32; shift += 8) {
+				hash = Mix(hash, static_cast<std::uint8_t>(value >> shift));
+			}
+			return hash;
+		}
+
+		std::uint64_t MakeKey(std::string_view pluginName, std::uint32_t localFormID) noexcept
+		{
+			return MixValue(MixName(kFnvOffset, pluginName), localFormID & 0xFFFFFF);
+		}
+
+		std::uint64_t HashLoadOrder(RE::TESDataHandler& dataHandler) noexcept
+		{
+			std::uint64_t hash = kFnvOffset;
+			for (const auto* file : dataHandler.compiledFileCollection.files) {
+				if (file) {
+					hash = MixValue(MixName(hash, file->filename), file->compileIndex);
+				}
+			}
+			for (const auto* file : dataHandler.compiledFileCollection.smallFiles) {
+				if (file) {
+					hash = MixValue(MixName(hash, file->filename), 0xFE000 | file->smallFileCompileIndex);
+				}
+			}
+			return hash;
+		}
+
+		std::optional<std::filesystem::path> CachePath()
+		{
+			auto path = logger::log_directory();
+			if (path) {
+				*path /= fmt::format(FMT_STRING("{}.formcache"), Version::PROJECT);
+			}
+			return path;
+		}
+	}
+
+	void Begin(RE::TESDataHandler& dataHandler)
+	{
+		std::scoped_lock lock(g_cache.lock);
+		g_cache.entries.clear();
+		g_cache.loadOrderHash = HashLoadOrder(dataHandler);
+		g_cache.dirty = false;
+
+		const auto path = CachePath();
+		if (!path) {
+			return;
+		}
+
+		std::ifstream file(*path, std::ios::binary);
+		if (!file) {
+			return;
+		}
+
+		Header header{};
+		ReadHeader(file, header);
+		if (!file || header.magic != kMagic || header.version != kVersion) {
+			logger::info("Ignoring unreadable form cache {}", path->string());
+			g_cache.dirty = true;
+			return;
+		}
+		if (header.loadOrderHash != g_cache.loadOrderHash) {
+			logger::info("Load order changed; discarding form cache {}", path->string());
+			g_cache.dirty = true;
+			return;
+		}
+
+		g_cache.entries.reserve(header.count);
+		for (std::uint32_t i = 0; i < header.count; ++i) {
+			Record record{};
+			ReadRecord(file, record);
+			if (!file) {
+				logger::warn("Truncated form cache {}", path->string());
+				g_cache.dirty = true;
+				break;
+			}
+			g_cache.entries.emplace(record.key, record.formID);
+		}
+
+		logger::info(FMT_STRING("Loaded {} cached form IDs"), g_cache.entries.size());
+	}
+
+	void Save()
+	{
+		std::scoped_lock lock(g_cache.lock);
+		if (!g_cache.dirty) {
+			return;
+		}
+
+		const auto path = CachePath();
+		if (!path) {
+			return;
+		}
+
+		std::ofstream file(*path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			logger::warn("Failed to write form cache {}", path->string());
+			return;
+		}
+
+		const Header header{ kMagic, kVersion, g_cache.loadOrderHash, static_cast<std::uint32_t>(g_cache.entries.size()) };
+		WriteHeader(file, header);
+		for (const auto& [key, formID] : g_cache.entries) {
+			const Record record{ key, formID };
+			WriteRecord(file, record);
+		}
+
+		g_cache.dirty = false;
+	}
+
+	std::uint32_t Find(std::string_view pluginName, std::uint32_t localFormID) noexcept
+	{
+		std::scoped_lock lock(g_cache.lock);
+		const auto it = g_cache.entries.find(MakeKey(pluginName, localFormID));
+		return it != g_cache.entries.end() ? it->second : 0;
+	}
+
+	void Remember(std::string_view pluginName, std::uint32_t localFormID, std::uint32_t formID)
+	{
+		std::scoped_lock lock(g_cache.lock);
+		auto [it, inserted] = g_cache.entries.try_emplace(MakeKey(pluginName, localFormID), formID);
+		if (inserted || it->second != formID) {
+			it->second = formID;
+			g_cache.dirty = true;
+		}
+	}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include <RE/Bethesda/TESDataHandler.h>
+#include <RE/Bethesda/TESForms.h>
+
+namespace Penetration::FormCache
+{
+	// Persistent map of (plugin name, local form ID) -> loaded form ID, stored next to the log and
+	// keyed by a hash of the active plugin list. Any load order change discards the whole file.
+	void Begin(RE::TESDataHandler& dataHandler);
+	void Save();
+
+	std::uint32_t Find(std::string_view pluginName, std::uint32_t localFormID) noexcept;
+	void Remember(std::string_view pluginName, std::uint32_t localFormID, std::uint32_t formID);
+
+	template <class T>
+	T* Resolve(RE::TESDataHandler& dataHandler, std::string_view pluginName, std::uint32_t localFormID)
+	{
+		if (const std::uint32_t cached = Find(pluginName, localFormID); cached != 0) {
+			if (auto* form = RE::TESForm::GetFormByID(cached)) {
+				if (auto* typed = form->As<T>()) {
+					return typed;
+				}
+			}
+		}
+
+		auto* form = dataHandler.LookupForm<T>(localFormID, pluginName);
+		if (form) {
+			Remember(pluginName, localFormID, form->GetFormID());
+		}
+		return form;
+	}
+}
@@ -0,0 +1,125 @@
+#include "LoadProfile.h"
+
+#include "MemoryTracking.h"
+
+#include <array>
+#include <fstream>
+#include <string_view>
+
+namespace Penetration::LoadProfile
+{
+	namespace
+	{
+		constexpr std::size_t kPhaseCount = static_cast<std::size_t>(Phase::kCount);
+
+		constexpr std::array<std::string_view, kPhaseCount> kPhaseNames{
+			"directoryScan",
+			"formCache",
+			"materialScan",
+			"tableBuild"
+		};
+
+		struct Report
+		{
+			std::chrono::steady_clock::time_point start{};
+			std::array<double, kPhaseCount> phases{};
+			Memory::Vector<Memory::Tag::kConfig, FileProfile> files;
+			std::size_t materialForms{ 0 };
+		};
+
+		Report g_report;
+
+		std::string EscapeJson(std::string_view value)
+		{
+			std::string escaped;
+			escaped.reserve(value.size());
+			for (const char ch : value) {
+				switch (ch) {
+				case '"':
+					escaped += "\\\"";
+					break;
+				case '\\':
+					escaped += "\\\\";
+					break;
+				default:
+					if (static_cast<unsigned char>(ch) < 0x20) {
+						escaped += fmt::format(FMT_STRING("\\u{:04x}"), static_cast<unsigned int>(ch));
+					} else {
+						escaped += ch;
+					}
+					break;
+				}
+			}
+			return escaped;
+		}
+	}
+
+	void Begin()
+	{
+		g_report = {};
+		g_report.start = std::chrono::steady_clock::now();
+	}
+
+	double& PhaseTime(Phase phase) noexcept
+	{
+		return g_report.phases[static_cast<std::size_t>(phase)];
+	}
+
+	FileProfile& AddFile(const std::filesystem::path& path)
+	{
+		auto& file = g_report.files.emplace_back();
+		file.name = path.filename().string();
+		return file;
+	}
+
+	void SetMaterialForms(std::size_t count) noexcept
+	{
+		g_report.materialForms = count;
+	}
+
+	void Write()
+	{
+		const double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - g_report.start).count();
+
+		auto path = logger::log_directory();
+		if (!path) {
+			return;
+		}
+		*path /= fmt::format(FMT_STRING("{}.loadprofile.json"), Version::PROJECT);
+
+		std::string json = fmt::format(FMT_STRING("{{\n  \"totalMs\": {:.3f},\n  \"phases\": {{"), totalMs);
+		for (std::size_t index = 0; index < kPhaseCount; ++index) {
+			json += fmt::format(FMT_STRING("{}\n    \"{}\": {:.3f}"), index ? "," : "", kPhaseNames[index], g_report.phases[index]);
+		}
+		json += fmt::format(FMT_STRING("\n  }},\n  \"materialForms\": {},\n  \"files\": ["), g_report.materialForms);
+
+		std::uintmax_t totalBytes = 0;
+		std::size_t totalEntries = 0;
+		for (std::size_t index = 0; index < g_report.files.size(); ++index) {
+			const auto& file = g_report.files[index];
+			totalBytes += file.bytes;
+			totalEntries += file.entries;
+			json += fmt::format(
+				FMT_STRING("{}\n    {{ \"name\": \"{}\", \"bytes\": {}, \"entries\": {}, \"readMs\": {:.3f}, \"parseMs\": {:.3f}, \"sortMs\": {:.3f}, \"resolveMs\": {:.3f}, \"materialsMs\": {:.3f} }}"),
+				index ? "," : "",
+				EscapeJson(file.name),
+				file.bytes,
+				file.entries,
+				file.readMs,
+				file.parseMs,
+				file.sortMs,
+				file.resolveMs,
+				file.materialsMs);
+		}
+		json += fmt::format(FMT_STRING("\n  ],\n  \"totalBytes\": {},\n  \"totalEntries\": {}\n}}\n"), totalBytes, totalEntries);
+
+		std::ofstream file(*path, std::ios::binary | std::ios::trunc);
+		if (!file) {
+			logger::warn("Failed to write load profile {}", path->string());
+			return;
+		}
+		file.write(json.data(), static_cast<std::streamsize>(json.size()));
+
+		logger::info(FMT_STRING("Penetration config loaded in {:.2f} ms; profile written to {}"), totalMs, path->string());
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace Penetration::LoadProfile
+{
+	enum class Phase : std::uint8_t
+	{
+		kDirectoryScan,
+		kFormCache,
+		kMaterialScan,
+		kTableBuild,
+
+		kCount
+	};
+
+	struct FileProfile
+	{
+		std::string name;
+		std::uintmax_t bytes{ 0 };
+		std::size_t entries{ 0 };
+		double readMs{ 0.0 };
+		double parseMs{ 0.0 };
+		double sortMs{ 0.0 };
+		double resolveMs{ 0.0 };
+		double materialsMs{ 0.0 };
+	};
+
+	// Adds the lifetime of the timer, in milliseconds, to `target`.
+	class ScopedTimer
+	{
+	public:
+		explicit ScopedTimer(double& target) noexcept :
+			target(target),
+			start(std::chrono::steady_clock::now())
+		{}
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+		~ScopedTimer()
+		{
+			target += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+	private:
+		double& target;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	void Begin();
+	double& PhaseTime(Phase phase) noexcept;
+	FileProfile& AddFile(const std::filesystem::path& path);
+	void SetMaterialForms(std::size_t count) noexcept;
+
+	// Writes the report as JSON next to the plugin log.
+	void Write();
+}
@@ -0,0 +1,126 @@
+#include "MemoryTracking.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string_view>
+
+namespace Penetration::Memory
+{
+	namespace
+	{
+		constexpr std::size_t kTagCount = static_cast<std::size_t>(Tag::kCount);
+
+		constexpr std::array<std::string_view, kTagCount> kTagNames{
+			"Config",
+			"Caches",
+			"PendingWork",
+			"Coroutines",
+			"Raycasts",
+			"Workers"
+		};
+
+		struct Counters
+		{
+			std::atomic<std::int64_t> live{ 0 };
+			std::atomic<std::int64_t> peak{ 0 };
+			std::atomic<std::uint64_t> allocations{ 0 };
+			std::uint64_t reportedAllocations{ 0 };
+		};
+
+		std::array<Counters, kTagCount> g_counters;
+
+		using Clock = std::chrono::steady_clock;
+		std::mutex g_reportLock;
+		Clock::time_point g_lastReport = Clock::now();
+
+		Counters& CountersFor(Tag tag) noexcept
+		{
+			return g_counters[static_cast<std::size_t>(tag)];
+		}
+
+		class TrackingResource final : public std::pmr::memory_resource
+		{
+		public:
+			constexpr explicit TrackingResource(Tag tag) noexcept :
+				tag(tag)
+			{}
+
+		private:
+			void* do_allocate(std::size_t bytes, std::size_t alignment) override
+			{
+				void* memory = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+				RecordAllocation(tag, bytes);
+				return memory;
+			}
+
+			void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) override
+			{
+				RecordDeallocation(tag, bytes);
+				std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+			}
+
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+			{
+				return this == std::addressof(other);
+			}
+
+			Tag tag;
+		};
+	}
+
+	void RecordAllocation(Tag tag, std::size_t bytes) noexcept
+	{
+		auto& counters = CountersFor(tag);
+		counters.allocations.fetch_add(1, std::memory_order_relaxed);
+
+		const std::int64_t live = counters.live.fetch_add(static_cast<std::int64_t>(bytes), std::memory_order_relaxed) + static_cast<std::int64_t>(bytes);
+		std::int64_t peak = counters.peak.load(std::memory_order_relaxed);
+		while (live > peak && !counters.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+		}
+	}
+
+	void RecordDeallocation(Tag tag, std::size_t bytes) noexcept
+	{
+		CountersFor(tag).live.fetch_sub(static_cast<std::int64_t>(bytes), std::memory_order_relaxed);
+	}
+
+	std::pmr::memory_resource* Resource(Tag tag) noexcept
+	{
+		static std::array<TrackingResource, kTagCount> resources{
+			TrackingResource{ Tag::kConfig },
+			TrackingResource{ Tag::kCaches },
+			TrackingResource{ Tag::kPendingWork },
+			TrackingResource{ Tag::kCoroutines },
+			TrackingResource{ Tag::kRaycasts },
+			TrackingResource{ Tag::kWorkers }
+		};
+		return std::addressof(resources[static_cast<std::size_t>(tag)]);
+	}
+
+	void LogStats()
+	{
+		std::scoped_lock lock(g_reportLock);
+
+		const auto now = Clock::now();
+		const double seconds = std::max(std::chrono::duration<double>(now - g_lastReport).count(), 1e-3);
+		g_lastReport = now;
+
+		for (std::size_t index = 0; index < kTagCount; ++index) {
+			auto& counters = g_counters[index];
+			const std::uint64_t allocations = counters.allocations.load(std::memory_order_relaxed);
+			const std::uint64_t recent = allocations - counters.reportedAllocations;
+			counters.reportedAllocations = allocations;
+
+			logger::info(
+				FMT_STRING("[Penetration] Memory {}: {} bytes live, peak {} bytes, {:.1f} allocations/s ({} total)"),
+				kTagNames[index],
+				counters.live.load(std::memory_order_relaxed),
+				counters.peak.load(std::memory_order_relaxed),
+				static_cast<double>(recent) / seconds,
+				allocations);
+		}
+	}
+}
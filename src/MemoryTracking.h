@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Penetration::Memory
+{
+	// Subsystems memory is charged to in the stats dump.
+	enum class Tag : std::uint8_t
+	{
+		kConfig,
+		kCaches,
+		kPendingWork,
+		kCoroutines,
+		kRaycasts,
+		kWorkers,
+
+		kCount
+	};
+
+	void RecordAllocation(Tag tag, std::size_t bytes) noexcept;
+	void RecordDeallocation(Tag tag, std::size_t bytes) noexcept;
+
+	// Heap allocator that charges every allocation to `kTag`. Stateless; all instances compare equal.
+	template <class T, Tag kTag>
+	struct TrackingAllocator
+	{
+		using value_type = T;
+
+		template <class U>
+		struct rebind
+		{
+			using other = TrackingAllocator<U, kTag>;
+		};
+
+		TrackingAllocator() noexcept = default;
+
+		template <class U>
+		TrackingAllocator(const TrackingAllocator<U, kTag>&) noexcept
+		{}
+
+		T* allocate(std::size_t count)
+		{
+			T* memory = std::allocator<T>{}.allocate(count);
+			RecordAllocation(kTag, count * sizeof(T));
+			return memory;
+		}
+
+		void deallocate(T* memory, std::size_t count) noexcept
+		{
+			RecordDeallocation(kTag, count * sizeof(T));
+			std::allocator<T>{}.deallocate(memory, count);
+		}
+
+		template <class U>
+		bool operator==(const TrackingAllocator<U, kTag>&) const noexcept
+		{
+			return true;
+		}
+	};
+
+	template <Tag kTag, class T>
+	using Vector = std::vector<T, TrackingAllocator<T, kTag>>;
+
+	template <Tag kTag, class T>
+	using List = std::list<T, TrackingAllocator<T, kTag>>;
+
+	template <Tag kTag, class T>
+	using Deque = std::deque<T, TrackingAllocator<T, kTag>>;
+
+	template <Tag kTag, class Key, class Value, class Compare = std::less<Key>>
+	using Map = std::map<Key, Value, Compare, TrackingAllocator<std::pair<const Key, Value>, kTag>>;
+
+	template <Tag kTag, class Key, class Value, class Hash = std::hash<Key>, class Equal = std::equal_to<Key>>
+	using UnorderedMap = std::unordered_map<Key, Value, Hash, Equal, TrackingAllocator<std::pair<const Key, Value>, kTag>>;
+
+	// Heap-backed memory resource charged to `tag`, for use as the upstream of pmr arenas.
+	std::pmr::memory_resource* Resource(Tag tag) noexcept;
+
+	// Logs live bytes, peak bytes and allocations per second since the previous dump, per tag.
+	void LogStats();
+}
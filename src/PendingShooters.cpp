@@ -0,0 +1,243 @@
+#include "PendingShooters.h"
+
+#include "PenetrationConfig.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Penetration::PendingShooters
+{
+	namespace
+	{
+		using Key = RE::ProjectileHandle::native_handle_type;
+
+		constexpr std::size_t kCapacity = 4096;
+		constexpr std::size_t kMaxProbe = 64;
+		constexpr std::size_t kSweepBatch = 16;
+		constexpr std::size_t kTickSweepBatch = 512;
+		static_assert((kCapacity & (kCapacity - 1)) == 0, "capacity must be a power of two");
+
+		constexpr Key kEmpty = 0;
+		constexpr Key kTombstone = 0xFFFFFFFF;
+		constexpr Key kReserved = 0xFFFFFFFE;
+
+		// A slot is claimed by CAS-ing its key to kReserved, filled, then published by storing the
+		// real key with release semantics. Removal CASes the key to kTombstone so probe chains stay
+		// intact; tombstones are reused by later inserts and wiped by Clear. The shooter payload is
+		// only touched while the key is kReserved, so a claim reserves the slot before reading it.
+		//
+		// Probing is bounded to kMaxProbe slots. Entries are stamped at insert time. A few slots are
+		// swept for expired entries on every insert and a larger batch on every scheduler tick while
+		// the table is not empty; a claim of an expired entry drops it instead, and a full probe
+		// window evicts its oldest entry. Projectiles that never reach ProcessImpacts therefore
+		// leave the table within a few frames of expiring, and Empty() turns true again once
+		// penetrations stop.
+		struct Slot
+		{
+			std::atomic<Key> key{ kEmpty };
+			std::atomic<std::uint32_t> stamp{ 0 };
+			RE::ObjectRefHandle shooter;
+		};
+
+		std::array<Slot, kCapacity> g_slots;
+		std::atomic<std::uint32_t> g_live{ 0 };
+		std::atomic<std::size_t> g_sweepCursor{ 0 };
+
+		std::atomic<std::uint64_t> g_expired{ 0 };
+		std::atomic<std::uint64_t> g_evicted{ 0 };
+		std::atomic<std::uint32_t> g_peakLive{ 0 };
+
+		std::uint32_t NowMs() noexcept
+		{
+			static const auto start = std::chrono::steady_clock::now();
+			const auto elapsed = std::chrono::steady_clock::now() - start;
+			return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+		}
+
+		bool IsLive(Key key) noexcept
+		{
+			return key != kEmpty && key != kTombstone && key != kReserved;
+		}
+
+		bool Remove(Slot& slot, Key key) noexcept
+		{
+			if (!slot.key.compare_exchange_strong(key, kTombstone, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				return false;
+			}
+			g_live.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		bool IsExpired(const Slot& slot, std::uint32_t now, std::uint32_t lifetime) noexcept
+		{
+			return lifetime != 0 && now - slot.stamp.load(std::memory_order_relaxed) > lifetime;
+		}
+
+		void Sweep(std::uint32_t now, std::uint32_t lifetime, std::size_t count) noexcept
+		{
+			if (lifetime == 0) {
+				return;
+			}
+
+			const std::size_t begin = g_sweepCursor.fetch_add(count, std::memory_order_relaxed);
+			for (std::size_t offset = 0; offset < count; ++offset) {
+				auto& slot = g_slots[(begin + offset) & (kCapacity - 1)];
+				const Key key = slot.key.load(std::memory_order_acquire);
+				if (!IsLive(key)) {
+					continue;
+				}
+
+				if (IsExpired(slot, now, lifetime) && Remove(slot, key)) {
+					g_expired.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		void Publish(Slot& slot, Key key, RE::ObjectRefHandle shooter, std::uint32_t now) noexcept
+		{
+			slot.shooter = shooter;
+			slot.stamp.store(now, std::memory_order_relaxed);
+			slot.key.store(key, std::memory_order_release);
+
+			const std::uint32_t live = g_live.fetch_add(1, std::memory_order_relaxed) + 1;
+			std::uint32_t peak = g_peakLive.load(std::memory_order_relaxed);
+			while (live > peak && !g_peakLive.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+		}
+
+		std::size_t HomeSlot(Key key) noexcept
+		{
+			return (static_cast<std::uint32_t>(key) * 0x9E3779B1u) & (kCapacity - 1);
+		}
+	}
+
+	void Queue(RE::ProjectileHandle projectile, RE::ObjectRefHandle shooter)
+	{
+		if (!projectile || !shooter) {
+			return;
+		}
+
+		const Key key = projectile.native_handle();
+		if (!IsLive(key)) {
+			return;
+		}
+
+		const std::uint32_t now = NowMs();
+		Sweep(now, GetSettings().pendingShooterLifetimeMs, kSweepBatch);
+
+		const std::size_t home = HomeSlot(key);
+		Slot* oldest = nullptr;
+		std::uint32_t oldestAge = 0;
+		for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+			auto& slot = g_slots[(home + probe) & (kCapacity - 1)];
+			Key current = slot.key.load(std::memory_order_relaxed);
+			if (IsLive(current)) {
+				const std::uint32_t age = now - slot.stamp.load(std::memory_order_relaxed);
+				if (!oldest || age > oldestAge) {
+					oldest = std::addressof(slot);
+					oldestAge = age;
+				}
+				continue;
+			}
+			if (current == kReserved) {
+				continue;
+			}
+
+			if (!slot.key.compare_exchange_strong(current, kReserved, std::memory_order_acquire, std::memory_order_relaxed)) {
+				continue;
+			}
+
+			Publish(slot, key, shooter, now);
+			return;
+		}
+
+		if (oldest) {
+			Key victim = oldest->key.load(std::memory_order_acquire);
+			if (IsLive(victim) && oldest->key.compare_exchange_strong(victim, kReserved, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+				g_live.fetch_sub(1, std::memory_order_relaxed);
+				g_evicted.fetch_add(1, std::memory_order_relaxed);
+				Publish(*oldest, key, shooter, now);
+				return;
+			}
+		}
+
+		logger::warn("[Penetration] Pending shooter table contended; dropping shooter assignment");
+	}
+
+	bool Claim(RE::ProjectileHandle projectile, RE::ObjectRefHandle& outShooter)
+	{
+		if (g_live.load(std::memory_order_relaxed) == 0) {
+			return false;
+		}
+
+		const Key key = projectile.native_handle();
+		if (!IsLive(key)) {
+			return false;
+		}
+
+		const std::size_t home = HomeSlot(key);
+		for (std::size_t probe = 0; probe < kMaxProbe; ++probe) {
+			auto& slot = g_slots[(home + probe) & (kCapacity - 1)];
+			const Key current = slot.key.load(std::memory_order_acquire);
+			if (current == kEmpty) {
+				return false;
+			}
+			if (current != key) {
+				continue;
+			}
+
+			Key expected = current;
+			if (!slot.key.compare_exchange_strong(expected, kReserved, std::memory_order_acquire, std::memory_order_relaxed)) {
+				return false;
+			}
+
+			const bool expired = IsExpired(slot, NowMs(), GetSettings().pendingShooterLifetimeMs);
+			if (!expired) {
+				outShooter = slot.shooter;
+			}
+			slot.key.store(kTombstone, std::memory_order_release);
+			g_live.fetch_sub(1, std::memory_order_relaxed);
+			if (expired) {
+				g_expired.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			return true;
+		}
+
+		return false;
+	}
+
+	void Expire() noexcept
+	{
+		if (g_live.load(std::memory_order_relaxed) == 0) {
+			return;
+		}
+		Sweep(NowMs(), GetSettings().pendingShooterLifetimeMs, kTickSweepBatch);
+	}
+
+	bool Empty() noexcept
+	{
+		return g_live.load(std::memory_order_relaxed) == 0;
+	}
+
+	void LogStats()
+	{
+		logger::info(
+			FMT_STRING("[Penetration] Pending shooters: {} live (peak {}), {} expired, {} evicted"),
+			g_live.load(std::memory_order_relaxed),
+			g_peakLive.load(std::memory_order_relaxed),
+			g_expired.load(std::memory_order_relaxed),
+			g_evicted.load(std::memory_order_relaxed));
+	}
+
+	void Clear()
+	{
+		for (auto& slot : g_slots) {
+			slot.key.store(kEmpty, std::memory_order_relaxed);
+			slot.stamp.store(0, std::memory_order_relaxed);
+			slot.shooter = {};
+		}
+		g_live.store(0, std::memory_order_release);
+	}
+}
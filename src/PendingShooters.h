@@ -0,0 +1,14 @@
+#pragma once
+
+#include <RE/Bethesda/BSPointerHandle.h>
+
+namespace Penetration::PendingShooters
+{
+	void Queue(RE::ProjectileHandle projectile, RE::ObjectRefHandle shooter);
+	bool Claim(RE::ProjectileHandle projectile, RE::ObjectRefHandle& outShooter);
+	// Sweeps a batch of slots for expired entries; called from the scheduler tick.
+	void Expire() noexcept;
+	bool Empty() noexcept;
+	void LogStats();
+	void Clear();
+}
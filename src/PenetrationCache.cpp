@@ -0,0 +1,531 @@
+#include "PenetrationCache.h"
+
+#include "MemoryTracking.h"
+#include "PenetrationConfig.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace Penetration::Cache
+{
+	namespace
+	{
+		constexpr float kPositionQuantum = 2.0f;
+		constexpr float kDirectionQuantum = 1.0f / 32.0f;
+
+		// Entry points are stored relative to the collidee's 3D root in world axes. Entries are
+		// dropped as soon as the root moves or rotates, so this is equivalent to a local-space
+		// key for as long as the entry is alive. The key is the collidee's handle,
+		// whose age bits change when the handle slot is reused; the collision body only
+		// validates the entry, since its address can be reused once the cell unloads.
+		struct ThicknessKey
+		{
+			std::uint32_t collidee{ 0 };
+			std::int16_t offset[3]{};
+			std::int8_t direction[3]{};
+
+			bool operator==(const ThicknessKey& other) const noexcept
+			{
+				return collidee == other.collidee &&
+				       offset[0] == other.offset[0] && offset[1] == other.offset[1] && offset[2] == other.offset[2] &&
+				       direction[0] == other.direction[0] && direction[1] == other.direction[1] && direction[2] == other.direction[2];
+			}
+		};
+
+		struct ThicknessKeyHash
+		{
+			std::size_t operator()(const ThicknessKey& key) const noexcept
+			{
+				std::size_t hash = std::hash<std::uint32_t>{}(key.collidee);
+				const auto mix = [&](std::size_t value) {
+					hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+				};
+				for (int axis = 0; axis < 3; ++axis) {
+					mix(static_cast<std::uint16_t>(key.offset[axis]));
+					mix(static_cast<std::uint8_t>(key.direction[axis]));
+				}
+				return hash;
+			}
+		};
+
+		struct ThicknessEntry
+		{
+			ThicknessKey key;
+			float thickness{ 0.0f };
+			RE::NiPoint3 exitNormal;
+			RE::NiTransform rootWorld;
+			const RE::TESObjectCELL* cell{ nullptr };
+			std::uintptr_t body{ 0 };
+			const void* root{ nullptr };
+		};
+
+		using ThicknessList = Memory::List<Memory::Tag::kCaches, ThicknessEntry>;
+
+		struct ThicknessCache
+		{
+			ThicknessList entries;
+			Memory::UnorderedMap<Memory::Tag::kCaches, ThicknessKey, ThicknessList::iterator, ThicknessKeyHash> index;
+			std::mutex lock;
+
+			std::atomic<std::uint64_t> hits{ 0 };
+			std::atomic<std::uint64_t> misses{ 0 };
+			std::atomic<std::uint64_t> evictions{ 0 };
+			std::atomic<std::uint64_t> invalidations{ 0 };
+		};
+
+		ThicknessCache g_thickness;
+
+		using Clock = std::chrono::steady_clock;
+
+		// Results from the last few milliseconds, bucketed on a grid whose cell size equals the
+		// coherence tolerance so any candidate within tolerance lives in the 27 surrounding cells.
+		// Each result carries its own timestamp, so it stays visible for the full lifetime no matter
+		// when it was stored.
+		struct CoherentResult
+		{
+			RE::NiPoint3 entry;
+			RE::NiPoint3 direction;
+			RE::NiPoint3 exitNormal;
+			float thickness{ 0.0f };
+			std::uint32_t collidee{ 0 };
+			const RE::BGSMaterialType* material{ nullptr };
+			Clock::time_point stamp{};
+		};
+
+		struct CoherenceCache
+		{
+			Memory::UnorderedMap<Memory::Tag::kCaches, std::uint64_t, Memory::Vector<Memory::Tag::kCaches, CoherentResult>> cells;
+			Clock::time_point lastPrune{};
+			std::mutex lock;
+
+			std::atomic<std::uint64_t> reused{ 0 };
+			std::atomic<std::uint64_t> rejected{ 0 };
+		};
+
+		CoherenceCache g_coherence;
+
+		std::uint64_t CoherenceCellKey(std::int32_t x, std::int32_t y, std::int32_t z) noexcept
+		{
+			constexpr std::uint64_t kMask = (1ull << 21) - 1;
+			return (static_cast<std::uint64_t>(x) & kMask) |
+			       ((static_cast<std::uint64_t>(y) & kMask) << 21) |
+			       ((static_cast<std::uint64_t>(z) & kMask) << 42);
+		}
+
+		// Cell coordinates are packed into 21 bits per axis; LoadConfig keeps the tolerance large
+		// enough for world coordinates to fit, and the clamp keeps the cast defined regardless.
+		std::int32_t CoherenceCell(float value, float cellSize) noexcept
+		{
+			constexpr float kLimit = static_cast<float>(1 << 20);
+			return static_cast<std::int32_t>(std::clamp(std::floor(value / cellSize), -kLimit, kLimit - 1.0f));
+		}
+
+		bool IsExpired(const CoherentResult& result, Clock::time_point now, const Settings& settings) noexcept
+		{
+			return now - result.stamp > std::chrono::milliseconds(settings.coherenceLifetimeMs);
+		}
+
+		// Drops expired results, at most once per lifetime; lookups skip expired results that are
+		// still stored. Must be called with the lock held.
+		void PruneCoherence(Clock::time_point now, const Settings& settings)
+		{
+			if (now - g_coherence.lastPrune < std::chrono::milliseconds(settings.coherenceLifetimeMs)) {
+				return;
+			}
+
+			g_coherence.lastPrune = now;
+			std::erase_if(g_coherence.cells, [&](auto& cell) {
+				std::erase_if(cell.second, [&](const CoherentResult& result) { return IsExpired(result, now, settings); });
+				return cell.second.empty();
+			});
+		}
+
+		bool CoherenceEnabled(const Settings& settings) noexcept
+		{
+			return settings.coherenceTolerance > 0.0f && settings.coherenceLifetimeMs > 0;
+		}
+
+		// Beams can report the same impact on consecutive frames. The outcome of the first
+		// evaluation is remembered per beam impact for a short time so repeats are free. While
+		// that evaluation is still deferred or queued, an in-flight entry suppresses repeats, so
+		// a beam under budget pressure does not start (and later spawn from) one pipeline per
+		// frame; the pipeline overwrites it with its outcome once it settles.
+		struct BeamImpactKeyHash
+		{
+			std::size_t operator()(const BeamImpactKey& key) const noexcept
+			{
+				std::size_t hash = std::hash<std::uint32_t>{}(key.beam);
+				const auto mix = [&](std::size_t value) {
+					hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2);
+				};
+				mix(key.collidee);
+				for (int axis = 0; axis < 3; ++axis) {
+					mix(static_cast<std::uint32_t>(key.location[axis]));
+				}
+				return hash;
+			}
+		};
+
+		struct BeamMemoEntry
+		{
+			BeamOutcome outcome{ BeamOutcome::kStopped };
+			Clock::time_point stamp{};
+		};
+
+		struct BeamMemo
+		{
+			static constexpr std::size_t kPruneThreshold = 256;
+
+			Memory::UnorderedMap<Memory::Tag::kCaches, BeamImpactKey, BeamMemoEntry, BeamImpactKeyHash> outcomes;
+			std::mutex lock;
+
+			std::atomic<std::uint64_t> hits{ 0 };
+		};
+
+		BeamMemo g_beamMemo;
+
+		std::int16_t QuantizePosition(float value) noexcept
+		{
+			return static_cast<std::int16_t>(std::clamp(std::lround(value / kPositionQuantum), -32768l, 32767l));
+		}
+
+		std::int8_t QuantizeDirection(float value) noexcept
+		{
+			return static_cast<std::int8_t>(std::clamp(std::lround(value / kDirectionQuantum), -127l, 127l));
+		}
+
+		// A settled entry lives for the memo lifetime. An in-flight entry is normally settled by its
+		// pipeline within the latency tolerance; the longer bound only covers a pipeline that is
+		// lost without settling.
+		std::chrono::milliseconds BeamMemoLifetime(const BeamMemoEntry& entry, const Settings& settings) noexcept
+		{
+			const std::uint32_t lifetime = entry.outcome == BeamOutcome::kInFlight ?
+			                                   std::max(settings.beamMemoLifetimeMs, settings.deferredLatencyMs) :
+			                                   settings.beamMemoLifetimeMs;
+			return std::chrono::milliseconds(lifetime);
+		}
+
+		bool SamePoint(const RE::NiPoint3& lhs, const RE::NiPoint3& rhs) noexcept
+		{
+			return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z;
+		}
+
+		// Bitwise, so any movement of the node, however small, invalidates.
+		bool SameTransform(const RE::NiTransform& lhs, const RE::NiTransform& rhs) noexcept
+		{
+			return SamePoint(lhs.translate, rhs.translate) &&
+			       lhs.scale == rhs.scale &&
+			       std::memcmp(std::addressof(lhs.rotate), std::addressof(rhs.rotate), sizeof(lhs.rotate)) == 0;
+		}
+
+		bool BuildKey(const ImpactSample& impact, const RE::NiPoint3& direction, ThicknessKey& outKey)
+		{
+			const RE::NiPoint3 offset = impact.location - impact.collideeWorld.translate;
+			outKey.collidee = impact.collidee.native_handle();
+			outKey.offset[0] = QuantizePosition(offset.x);
+			outKey.offset[1] = QuantizePosition(offset.y);
+			outKey.offset[2] = QuantizePosition(offset.z);
+			outKey.direction[0] = QuantizeDirection(direction.x);
+			outKey.direction[1] = QuantizeDirection(direction.y);
+			outKey.direction[2] = QuantizeDirection(direction.z);
+			return outKey.collidee != 0 && impact.collideeRoot != nullptr;
+		}
+
+		// A reload of the collidee's 3D (cell detach and reattach) replaces both the root node and
+		// the collision body, so either differing means the entry describes geometry that is gone.
+		// The root's world transform catches bodies that move while loaded: doors and other
+		// animated or keyframed objects. Compares against the collidee state captured in the
+		// sample; the ref is never touched.
+		bool IsStale(const ThicknessEntry& entry, const ImpactSample& impact)
+		{
+			return entry.root != impact.collideeRoot ||
+			       entry.body != impact.body ||
+			       entry.cell != impact.collideeCell ||
+			       !SameTransform(entry.rootWorld, impact.collideeWorld);
+		}
+	}
+
+	bool LookupExit(const ImpactSample& impact, const RE::NiPoint3& direction, Utils::RaycastHit& outExit, float& outThickness)
+	{
+		if (GetSettings().thicknessCacheCapacity == 0) {
+			return false;
+		}
+
+		ThicknessKey key;
+		if (!BuildKey(impact, direction, key)) {
+			return false;
+		}
+
+		std::scoped_lock lock(g_thickness.lock);
+		const auto it = g_thickness.index.find(key);
+		if (it == g_thickness.index.end()) {
+			g_thickness.misses.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		if (IsStale(*it->second, impact)) {
+			g_thickness.entries.erase(it->second);
+			g_thickness.index.erase(it);
+			g_thickness.invalidations.fetch_add(1, std::memory_order_relaxed);
+			g_thickness.misses.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		g_thickness.entries.splice(g_thickness.entries.begin(), g_thickness.entries, it->second);
+		outThickness = it->second->thickness;
+		outExit.point = impact.location + direction * outThickness;
+		outExit.normal = it->second->exitNormal;
+		g_thickness.hits.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void StoreExit(const ImpactSample& impact, const RE::NiPoint3& direction, const Utils::RaycastHit& exit, float thickness)
+	{
+		const std::size_t capacity = GetSettings().thicknessCacheCapacity;
+		if (capacity == 0) {
+			return;
+		}
+
+		ThicknessKey key;
+		if (!BuildKey(impact, direction, key)) {
+			return;
+		}
+
+		ThicknessEntry entry{
+			.key = key,
+			.thickness = thickness,
+			.exitNormal = exit.normal,
+			.rootWorld = impact.collideeWorld,
+			.cell = impact.collideeCell,
+			.body = impact.body,
+			.root = impact.collideeRoot
+		};
+
+		std::scoped_lock lock(g_thickness.lock);
+		if (const auto it = g_thickness.index.find(key); it != g_thickness.index.end()) {
+			*it->second = entry;
+			g_thickness.entries.splice(g_thickness.entries.begin(), g_thickness.entries, it->second);
+			return;
+		}
+
+		while (g_thickness.entries.size() >= capacity) {
+			g_thickness.index.erase(g_thickness.entries.back().key);
+			g_thickness.entries.pop_back();
+			g_thickness.evictions.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		g_thickness.entries.push_front(entry);
+		g_thickness.index.emplace(key, g_thickness.entries.begin());
+	}
+
+	bool LookupCoherent(const ImpactSample& impact, const RE::NiPoint3& direction, Utils::RaycastHit& outExit, float& outThickness)
+	{
+		const auto& settings = GetSettings();
+		if (!CoherenceEnabled(settings)) {
+			return false;
+		}
+
+		// Without a collidee there is nothing tying two impacts to the same object.
+		const std::uint32_t collidee = impact.collidee.native_handle();
+		if (collidee == 0) {
+			return false;
+		}
+
+		const float tolerance = settings.coherenceTolerance;
+		const float minDot = std::cos(settings.coherenceAngle * 0.01745329252f);
+		const std::int32_t cx = CoherenceCell(impact.location.x, tolerance);
+		const std::int32_t cy = CoherenceCell(impact.location.y, tolerance);
+		const std::int32_t cz = CoherenceCell(impact.location.z, tolerance);
+
+		const CoherentResult* best = nullptr;
+		float bestConfidence = 0.0f;
+
+		const auto now = Clock::now();
+		std::scoped_lock lock(g_coherence.lock);
+		PruneCoherence(now, settings);
+		if (g_coherence.cells.empty()) {
+			return false;
+		}
+
+		for (std::int32_t dx = -1; dx <= 1; ++dx) {
+			for (std::int32_t dy = -1; dy <= 1; ++dy) {
+				for (std::int32_t dz = -1; dz <= 1; ++dz) {
+					const auto it = g_coherence.cells.find(CoherenceCellKey(cx + dx, cy + dy, cz + dz));
+					if (it == g_coherence.cells.end()) {
+						continue;
+					}
+
+					for (const auto& result : it->second) {
+						if (result.collidee != collidee || result.material != impact.materialType || IsExpired(result, now, settings)) {
+							continue;
+						}
+
+						const float distance = result.entry.GetDistance(impact.location);
+						const float dot = result.direction.Dot(direction);
+						if (distance > tolerance || dot < minDot) {
+							continue;
+						}
+
+						const float distanceScore = 1.0f - distance / tolerance;
+						const float angleScore = minDot < 1.0f ? (dot - minDot) / (1.0f - minDot) : 1.0f;
+						const float confidence = distanceScore * angleScore;
+						if (confidence > bestConfidence) {
+							bestConfidence = confidence;
+							best = std::addressof(result);
+						}
+					}
+				}
+			}
+		}
+
+		if (!best || bestConfidence < settings.coherenceMinConfidence) {
+			g_coherence.rejected.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		// Reproject the neighbour's exit onto the new ray: same thickness along the path, starting
+		// from this impact's own entry point.
+		outThickness = best->thickness;
+		outExit.point = impact.location + direction * outThickness;
+		outExit.normal = best->exitNormal;
+		g_coherence.reused.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void StoreCoherent(const ImpactSample& impact, const RE::NiPoint3& direction, const Utils::RaycastHit& exit, float thickness)
+	{
+		const auto& settings = GetSettings();
+		if (!CoherenceEnabled(settings)) {
+			return;
+		}
+
+		const std::uint32_t collidee = impact.collidee.native_handle();
+		if (collidee == 0) {
+			return;
+		}
+
+		const float tolerance = settings.coherenceTolerance;
+		const std::uint64_t key = CoherenceCellKey(
+			CoherenceCell(impact.location.x, tolerance),
+			CoherenceCell(impact.location.y, tolerance),
+			CoherenceCell(impact.location.z, tolerance));
+
+		const auto now = Clock::now();
+		std::scoped_lock lock(g_coherence.lock);
+		PruneCoherence(now, settings);
+		g_coherence.cells[key].push_back({
+			.entry = impact.location,
+			.direction = direction,
+			.exitNormal = exit.normal,
+			.thickness = thickness,
+			.collidee = collidee,
+			.material = impact.materialType,
+			.stamp = now });
+	}
+
+	BeamImpactKey MakeBeamImpactKey(RE::ProjectileHandle beam, const RE::Projectile::ImpactData& impact) noexcept
+	{
+		return {
+			.beam = beam.native_handle(),
+			.collidee = impact.collidee.native_handle(),
+			.location = {
+				static_cast<std::int32_t>(std::lround(impact.location.x)),
+				static_cast<std::int32_t>(std::lround(impact.location.y)),
+				static_cast<std::int32_t>(std::lround(impact.location.z)) }
+		};
+	}
+
+	bool RecallBeamOutcome(const BeamImpactKey& key, BeamOutcome& outOutcome)
+	{
+		const auto& settings = GetSettings();
+		if (settings.beamMemoLifetimeMs == 0 || key.beam == 0) {
+			return false;
+		}
+
+		std::scoped_lock lock(g_beamMemo.lock);
+		const auto it = g_beamMemo.outcomes.find(key);
+		if (it == g_beamMemo.outcomes.end()) {
+			return false;
+		}
+
+		if (Clock::now() - it->second.stamp > BeamMemoLifetime(it->second, settings)) {
+			g_beamMemo.outcomes.erase(it);
+			return false;
+		}
+
+		outOutcome = it->second.outcome;
+		g_beamMemo.hits.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	void RememberBeamOutcome(const BeamImpactKey& key, BeamOutcome outcome)
+	{
+		const auto& settings = GetSettings();
+		if (settings.beamMemoLifetimeMs == 0 || key.beam == 0) {
+			return;
+		}
+
+		const auto now = Clock::now();
+		std::scoped_lock lock(g_beamMemo.lock);
+		if (g_beamMemo.outcomes.size() >= BeamMemo::kPruneThreshold) {
+			std::erase_if(g_beamMemo.outcomes, [&](const auto& entry) {
+				return now - entry.second.stamp > BeamMemoLifetime(entry.second, settings);
+			});
+		}
+		g_beamMemo.outcomes[key] = { outcome, now };
+	}
+
+	void Clear()
+	{
+		{
+			std::scoped_lock lock(g_thickness.lock);
+			g_thickness.entries.clear();
+			g_thickness.index.clear();
+		}
+		g_thickness.hits.store(0, std::memory_order_relaxed);
+		g_thickness.misses.store(0, std::memory_order_relaxed);
+		g_thickness.evictions.store(0, std::memory_order_relaxed);
+		g_thickness.invalidations.store(0, std::memory_order_relaxed);
+		g_coherence.reused.store(0, std::memory_order_relaxed);
+		g_coherence.rejected.store(0, std::memory_order_relaxed);
+		g_beamMemo.hits.store(0, std::memory_order_relaxed);
+		{
+			std::scoped_lock lock(g_coherence.lock);
+			g_coherence.cells.clear();
+		}
+		{
+			std::scoped_lock lock(g_beamMemo.lock);
+			g_beamMemo.outcomes.clear();
+		}
+	}
+
+	void LogStats()
+	{
+		const auto hits = g_thickness.hits.load(std::memory_order_relaxed);
+		const auto misses = g_thickness.misses.load(std::memory_order_relaxed);
+		const auto lookups = hits + misses;
+		logger::info(
+			FMT_STRING("[Penetration] Thickness cache: {} hits / {} lookups ({:.1f}%), {} evictions, {} invalidations"),
+			hits,
+			lookups,
+			lookups ? 100.0 * static_cast<double>(hits) / static_cast<double>(lookups) : 0.0,
+			g_thickness.evictions.load(std::memory_order_relaxed),
+			g_thickness.invalidations.load(std::memory_order_relaxed));
+		logger::info(
+			FMT_STRING("[Penetration] Coherence reuse: {} reused, {} fell back to a cast"),
+			g_coherence.reused.load(std::memory_order_relaxed),
+			g_coherence.rejected.load(std::memory_order_relaxed));
+		logger::info(
+			FMT_STRING("[Penetration] Beam memo: {} repeated impacts reused"),
+			g_beamMemo.hits.load(std::memory_order_relaxed));
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "PenetrationSnapshot.h"
+#include "Utils.h"
+
+#include <RE/Bethesda/Projectiles.h>
+
+namespace Penetration::Cache
+{
+	bool LookupExit(const ImpactSample& impact, const RE::NiPoint3& direction, Utils::RaycastHit& outExit, float& outThickness);
+	void StoreExit(const ImpactSample& impact, const RE::NiPoint3& direction, const Utils::RaycastHit& exit, float thickness);
+
+	bool LookupCoherent(const ImpactSample& impact, const RE::NiPoint3& direction, Utils::RaycastHit& outExit, float& outThickness);
+	void StoreCoherent(const ImpactSample& impact, const RE::NiPoint3& direction, const Utils::RaycastHit& exit, float thickness);
+
+	enum class BeamOutcome
+	{
+		kStopped,
+		kPenetrated,
+		kInFlight
+	};
+
+	BeamImpactKey MakeBeamImpactKey(RE::ProjectileHandle beam, const RE::Projectile::ImpactData& impact) noexcept;
+	bool RecallBeamOutcome(const BeamImpactKey& key, BeamOutcome& outOutcome);
+	void RememberBeamOutcome(const BeamImpactKey& key, BeamOutcome outcome);
+
+	void Clear();
+	void LogStats();
+}
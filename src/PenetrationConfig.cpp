@@ -1,19 +1,32 @@
 #include "PenetrationConfig.h"
 
+#include "FormCache.h"
+#include "LoadProfile.h"
+#include "MemoryTracking.h"
 #include "Utils.h"
 
 #include <algorithm>
-#include <charconv>
+#include <array>
+#include <atomic>
 #include <cmath>
-#include <cstdlib>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <unordered_map>
-#include <system_error>
+#include <utility>
+#include <vector>
 
 #include <SimpleIni.h>
 
+#include <RE/Bethesda/TESBoundObjects.h>
 #include <RE/Bethesda/TESDataHandler.h>
 #include <RE/Bethesda/TESForms.h>
 
@@ -21,26 +34,148 @@ namespace Penetration
 {
 	namespace
 	{
+		constexpr std::string_view kGeneralSection{ "General" };
 		constexpr std::string_view kAmmoSection{ "AmmoMult" };
+		constexpr std::string_view kAmmoCurveSection{ "AmmoCurve" };
 		constexpr std::string_view kMaterialSection{ "MaterialMult" };
+		constexpr std::string_view kCriticalAngleSection{ "MaterialCriticalAngle" };
+		constexpr std::string_view kUtf8Bom{ "\xEF\xBB\xBF" };
+		constexpr float kDegreesToRadians = 0.01745329252f;
+		constexpr float kMinCoherenceTolerance = 1.0f;
 
-		std::unordered_map<const RE::TESAmmo*, float> g_penetrationByAmmo;
-		std::unordered_map<const RE::BGSMaterialType*, float> g_penetrationByMaterial;
+		using MaterialValues = Memory::UnorderedMap<Memory::Tag::kConfig, const RE::BGSMaterialType*, float>;
 
-		bool TryParseFormID(std::string_view value, std::uint32_t& outFormID)
+		// Ammo settings hold a curve index rather than a pointer so the curve table can grow while
+		// loading; identical curves share one table entry.
+		struct AmmoEntry
 		{
-			std::string trimmed = Utils::Trim(value);
-			if (trimmed.empty()) {
-				return false;
+			float multiplier{ 1.0f };
+			std::int32_t curve{ -1 };
+		};
+
+		struct CurveHash
+		{
+			std::size_t operator()(const PenetrationCurve& curve) const noexcept
+			{
+				std::size_t hash = 0;
+				const auto combine = [&](float value) {
+					hash ^= std::hash<float>{}(value) + 0x9E3779B9 + (hash << 6) + (hash >> 2);
+				};
+				std::for_each(curve.x.begin(), curve.x.end(), combine);
+				std::for_each(curve.y.begin(), curve.y.end(), combine);
+				return hash;
+			}
+		};
+
+		struct CurveEqual
+		{
+			bool operator()(const PenetrationCurve& lhs, const PenetrationCurve& rhs) const noexcept
+			{
+				return lhs.x == rhs.x && lhs.y == rhs.y;
+			}
+		};
+
+		Memory::UnorderedMap<Memory::Tag::kConfig, const RE::TESAmmo*, AmmoEntry> g_penetrationByAmmo;
+		Memory::Vector<Memory::Tag::kConfig, PenetrationCurve> g_curves;
+		Memory::UnorderedMap<Memory::Tag::kConfig, PenetrationCurve, std::int32_t, CurveHash, CurveEqual> g_curveIndex;
+		MaterialValues g_penetrationByMaterial;
+		MaterialValues g_criticalCosByMaterial;
+		float g_defaultCriticalCos = -std::numeric_limits<float>::infinity();
+		Settings g_settings;
+
+		// Hashed bitset of ammo that may penetrate: a positive multiplier and a depth curve that is
+		// not flat at zero. Collisions only produce false positives, which fall through to the exact
+		// checks in TryHandlePenetration.
+		struct AmmoEligibility
+		{
+			static constexpr std::size_t kBits = 1 << 16;
+
+			std::array<std::uint64_t, kBits / 64> bits{};
+			std::atomic<bool> built{ false };
+
+			static std::size_t Slot(std::uint32_t formID) noexcept
+			{
+				return (formID * 0x9E3779B1u) >> 16;
+			}
+
+			void Set(std::uint32_t formID) noexcept
+			{
+				const std::size_t slot = Slot(formID);
+				bits[slot >> 6] |= 1ull << (slot & 63);
+			}
+
+			bool Test(std::uint32_t formID) const noexcept
+			{
+				const std::size_t slot = Slot(formID);
+				return (bits[slot >> 6] & (1ull << (slot & 63))) != 0;
 			}
+		};
 
-			if (trimmed.rfind("0x", 0) == 0 || trimmed.rfind("0X", 0) == 0) {
-				trimmed.erase(0, 2);
+		AmmoEligibility g_eligibleAmmo;
+
+		// Config problems are counted while loading and reported as one line per file and one line
+		// per missing plugin; each individual entry is only logged at trace level.
+		struct FileDiagnostics
+		{
+			std::size_t invalidKeys{ 0 };
+			std::size_t invalidFormIDs{ 0 };
+			std::size_t invalidValues{ 0 };
+			std::size_t unresolvedForms{ 0 };
+			std::size_t missingPluginEntries{ 0 };
+
+			bool Empty() const noexcept
+			{
+				return invalidKeys + invalidFormIDs + invalidValues + unresolvedForms + missingPluginEntries == 0;
 			}
+		};
+
+		struct Diagnostics
+		{
+			FileDiagnostics file;
+			Memory::Map<Memory::Tag::kConfig, std::string, std::size_t, std::less<>> missingPlugins;
+			std::size_t materialsApplied{ 0 };
+		};
 
+		Diagnostics g_diagnostics;
+
+		void ReportFileDiagnostics(const std::filesystem::path& path)
+		{
+			const auto& file = g_diagnostics.file;
+			if (!file.Empty()) {
+				logger::warn(
+					FMT_STRING("{}: {} invalid keys, {} invalid form IDs, {} invalid values, {} unresolved forms, {} entries for missing plugins"),
+					path.filename().string(),
+					file.invalidKeys,
+					file.invalidFormIDs,
+					file.invalidValues,
+					file.unresolvedForms,
+					file.missingPluginEntries);
+			}
+			g_diagnostics.file = {};
+		}
+
+		void ReportMissingPlugins()
+		{
+			for (const auto& [plugin, count] : g_diagnostics.missingPlugins) {
+				logger::warn(FMT_STRING("{} penetration entries reference {}, which is not loaded"), count, plugin);
+			}
+			g_diagnostics.missingPlugins.clear();
+		}
+
+		void RecordMissingPlugin(std::string_view pluginName)
+		{
+			++g_diagnostics.file.missingPluginEntries;
+			if (auto it = g_diagnostics.missingPlugins.find(pluginName); it != g_diagnostics.missingPlugins.end()) {
+				++it->second;
+			} else {
+				g_diagnostics.missingPlugins.emplace(pluginName, 1);
+			}
+		}
+
+		bool TryParseFormID(std::string_view value, std::uint32_t& outFormID)
+		{
 			std::uint32_t parsed = 0;
-			auto [ptr, ec] = std::from_chars(trimmed.data(), trimmed.data() + trimmed.size(), parsed, 16);
-			if (ec != std::errc{} || ptr != trimmed.data() + trimmed.size()) {
+			if (!Utils::ParseHex(value, parsed)) {
 				return false;
 			}
 
@@ -48,126 +183,565 @@ namespace Penetration
 			return true;
 		}
 
-		bool TryParseFloat(std::string_view value, float& outValue)
+		void LoadGeneral(const CSimpleIniA& ini, const std::filesystem::path& path)
 		{
-			std::string trimmed = Utils::Trim(value);
-			if (trimmed.empty()) {
-				return false;
-			}
+			const auto readUInt = [&](const char* key, std::uint32_t& outValue) {
+				if (const char* value = ini.GetValue(kGeneralSection.data(), key)) {
+					if (!Utils::ParseUInt(value, outValue)) {
+						++g_diagnostics.file.invalidValues;
+						logger::trace("Invalid {} '{}' in {}", key, value, path.string());
+					}
+				}
+			};
+			const auto readFloat = [&](const char* key, float& outValue) {
+				if (const char* value = ini.GetValue(kGeneralSection.data(), key)) {
+					if (!Utils::ParseFloat(value, outValue)) {
+						++g_diagnostics.file.invalidValues;
+						logger::trace("Invalid {} '{}' in {}", key, value, path.string());
+					}
+				}
+			};
+
+			const auto readBool = [&](const char* key, bool& outValue) {
+				std::uint32_t parsed = outValue ? 1 : 0;
+				readUInt(key, parsed);
+				outValue = parsed != 0;
+			};
+
+			readUInt("ThicknessCacheSize", g_settings.thicknessCacheCapacity);
+			readFloat("CoherenceTolerance", g_settings.coherenceTolerance);
+			readFloat("CoherenceAngle", g_settings.coherenceAngle);
+			readFloat("CoherenceMinConfidence", g_settings.coherenceMinConfidence);
+			readUInt("CoherenceLifetimeMs", g_settings.coherenceLifetimeMs);
+			readFloat("CriticalAngle", g_settings.criticalAngle);
+			readUInt("MaxLayers", g_settings.maxLayers);
+			readUInt("PendingShooterLifetimeMs", g_settings.pendingShooterLifetimeMs);
+			readUInt("BeamMemoLifetimeMs", g_settings.beamMemoLifetimeMs);
+			readUInt("RaycastBudget", g_settings.raycastBudget);
+			readUInt("DeferredQueueSize", g_settings.deferredQueueSize);
+			readUInt("DeferredLatencyMs", g_settings.deferredLatencyMs);
+			readBool("AsyncResolution", g_settings.asyncResolution);
+			readUInt("AsyncWorkers", g_settings.asyncWorkers);
+			readBool("DeterministicWorkers", g_settings.deterministicWorkers);
+			readFloat("LayerSearchDistance", g_settings.layerSearchDistance);
+		}
 
-			char* endPtr = nullptr;
-			outValue = std::strtof(trimmed.c_str(), &endPtr);
-			return endPtr == trimmed.c_str() + trimmed.size() && std::isfinite(outValue);
+		// Cosine an impact's incidence must reach to be evaluated. 90 degrees or more disables the
+		// test, matching the behaviour without any critical angle configured.
+		float CriticalCosine(float degrees) noexcept
+		{
+			if (degrees >= 90.0f) {
+				return -std::numeric_limits<float>::infinity();
+			}
+			return std::cos(std::max(degrees, 0.0f) * kDegreesToRadians);
 		}
 
-		void LoadFile(const std::filesystem::path& path, RE::TESDataHandler& dataHandler)
+		// Applied once after every file is read. The coherence grid divides world positions by the
+		// tolerance and packs the result into 21 bits per axis, so tiny tolerances are raised to a
+		// size that keeps world coordinates in range; zero or negative disables reuse.
+		void ClampSettings()
 		{
-			CSimpleIniA ini(true, false, false);
-			if (ini.LoadFile(path.string().c_str()) < 0) {
-				logger::warn("Failed to load penetration config: {}", path.string());
-				return;
+			if (g_settings.coherenceTolerance > 0.0f) {
+				g_settings.coherenceTolerance = std::max(g_settings.coherenceTolerance, kMinCoherenceTolerance);
+			} else {
+				g_settings.coherenceTolerance = 0.0f;
 			}
+		}
 
-			CSimpleIniA::TNamesDepend ammoKeys;
-			ini.GetAllKeys(kAmmoSection.data(), ammoKeys);
-			ammoKeys.sort(CSimpleIniA::Entry::LoadOrder());
+		struct EditorIDHash
+		{
+			using is_transparent = void;
+
+			std::size_t operator()(std::string_view value) const noexcept { return std::hash<std::string_view>{}(value); }
+		};
+
+		using MaterialOverrides = Memory::UnorderedMap<Memory::Tag::kConfig, std::string, float, EditorIDHash, std::equal_to<>>;
+
+		// Material sections from every file, merged in load order (later files win) and resolved
+		// against the material forms once after all files are read.
+		struct PendingMaterials
+		{
+			MaterialOverrides multipliers;
+			MaterialOverrides criticalAngles;
+		};
 
-			for (const auto& entry : ammoKeys) {
+		void ReadMaterialSection(const CSimpleIniA& ini, std::string_view section, const std::filesystem::path& path, MaterialOverrides& overrides)
+		{
+			CSimpleIniA::TNamesDepend materialKeys;
+			ini.GetAllKeys(section.data(), materialKeys);
+			materialKeys.sort(CSimpleIniA::Entry::LoadOrder());
+
+			for (const auto& entry : materialKeys) {
 				const char* key = entry.pItem;
 				if (!key) {
 					continue;
 				}
 
-				const char* value = ini.GetValue(kAmmoSection.data(), key);
+				const char* value = ini.GetValue(section.data(), key);
 				if (!value) {
 					continue;
 				}
 
-				std::string remainder;
-				std::string pluginName = Utils::Trim(Utils::SplitString(key, "|", remainder));
-				remainder = Utils::Trim(remainder);
-
-				if (pluginName.empty() || remainder.empty()) {
-					logger::warn("Invalid penetration config key '{}' in {}", key, path.string());
+				float parsed = 0.0f;
+				if (!Utils::ParseFloat(value, parsed)) {
+					++g_diagnostics.file.invalidValues;
+					logger::trace("Invalid {} value '{}' for {} in {}", section, value, key, path.string());
 					continue;
 				}
 
-				std::uint32_t formID = 0;
-				if (!TryParseFormID(remainder, formID)) {
-					logger::warn("Invalid form ID '{}' in {}", remainder, path.string());
+				const std::string_view materialKey = Utils::TrimView(key);
+				if (materialKey.empty()) {
 					continue;
 				}
 
-				float multiplier = 0.0f;
-				if (!TryParseFloat(value, multiplier)) {
-					logger::warn("Invalid multiplier '{}' for {} in {}", value, key, path.string());
+				if (auto it = overrides.find(materialKey); it != overrides.end()) {
+					it->second = parsed;
+				} else {
+					overrides.emplace(materialKey, parsed);
+				}
+			}
+		}
+
+		void ResolveMaterials(RE::TESDataHandler& dataHandler, const PendingMaterials& pending)
+		{
+			if (pending.multipliers.empty() && pending.criticalAngles.empty()) {
+				return;
+			}
+
+			const auto& materials = dataHandler.GetFormArray<RE::BGSMaterialType>();
+			LoadProfile::SetMaterialForms(materials.size());
+			for (auto* material : materials) {
+				if (!material) {
 					continue;
 				}
 
-				auto* ammo = dataHandler.LookupForm<RE::TESAmmo>(formID, pluginName);
-				if (!ammo) {
-					logger::warn("Unable to resolve ammo {}|{:06X} in {}", pluginName, formID, path.string());
+				const char* editorID = material->GetFormEditorID();
+				if (!editorID || *editorID == '\0') {
 					continue;
 				}
 
-				g_penetrationByAmmo[ammo] = multiplier;
+				const std::string_view key{ editorID };
+				if (auto it = pending.multipliers.find(key); it != pending.multipliers.end()) {
+					++g_diagnostics.materialsApplied;
+					logger::trace("Added {} mult: {:.2f}", editorID, it->second);
+					g_penetrationByMaterial[material] = it->second;
+				}
+				if (auto it = pending.criticalAngles.find(key); it != pending.criticalAngles.end()) {
+					const float cosine = CriticalCosine(it->second);
+					++g_diagnostics.materialsApplied;
+					logger::trace("Added {} critical angle cosine: {:.2f}", editorID, cosine);
+					g_criticalCosByMaterial[material] = cosine;
+				}
 			}
+		}
 
-			std::unordered_map<std::string, float> materialOverrides;
-			CSimpleIniA::TNamesDepend materialKeys;
-			ini.GetAllKeys(kMaterialSection.data(), materialKeys);
-			materialKeys.sort(CSimpleIniA::Entry::LoadOrder());
+		// Ammo whose multiplier or curve can never yield depth is never evaluated. Explosive shots
+		// are not excluded here: weapon mods can swap the projectile independently of the ammo, so
+		// they are rejected per shot by the hook instead.
+		bool CanPenetrate(const RE::TESAmmo& ammo)
+		{
+			const AmmoPenetration penetration = GetAmmoPenetration(std::addressof(ammo));
+			if (penetration.multiplier <= 0.0f) {
+				return false;
+			}
+			return !penetration.curve || *std::max_element(penetration.curve->y.begin(), penetration.curve->y.end()) > 0.0f;
+		}
 
-			for (const auto& entry : materialKeys) {
-				const char* key = entry.pItem;
-				if (!key) {
-					continue;
+		void BuildEligibility(RE::TESDataHandler& dataHandler)
+		{
+			g_eligibleAmmo.bits.fill(0);
+
+			std::size_t eligible = 0;
+			for (auto* ammo : dataHandler.GetFormArray<RE::TESAmmo>()) {
+				if (ammo && CanPenetrate(*ammo)) {
+					g_eligibleAmmo.Set(ammo->formID);
+					++eligible;
 				}
+			}
 
-				const char* value = ini.GetValue(kMaterialSection.data(), key);
-				if (!value) {
-					continue;
+			g_eligibleAmmo.built.store(true, std::memory_order_release);
+			logger::info(FMT_STRING("{} ammunition forms are eligible for penetration"), eligible);
+		}
+
+		// Shared by the INI and table loaders so both resolve and override entries identically.
+		void ApplyAmmoEntry(
+			RE::TESDataHandler& dataHandler,
+			std::string_view pluginName,
+			std::string_view formIDText,
+			std::string_view valueText,
+			const std::filesystem::path& path)
+		{
+			std::uint32_t formID = 0;
+			if (!TryParseFormID(formIDText, formID)) {
+				++g_diagnostics.file.invalidFormIDs;
+				logger::trace("Invalid form ID '{}' in {}", formIDText, path.string());
+				return;
+			}
+
+			float multiplier = 0.0f;
+			if (!Utils::ParseFloat(valueText, multiplier)) {
+				++g_diagnostics.file.invalidValues;
+				logger::trace("Invalid multiplier '{}' for {}|{} in {}", valueText, pluginName, formIDText, path.string());
+				return;
+			}
+
+			auto* ammo = FormCache::Resolve<RE::TESAmmo>(dataHandler, pluginName, formID);
+			if (!ammo) {
+				if (dataHandler.LookupModByName(pluginName)) {
+					++g_diagnostics.file.unresolvedForms;
+				} else {
+					RecordMissingPlugin(pluginName);
 				}
+				logger::trace("Unable to resolve ammo {}|{:06X} in {}", pluginName, formID, path.string());
+				return;
+			}
 
-				float multiplier = 0.0f;
-				if (!TryParseFloat(value, multiplier)) {
-					logger::warn("Invalid material multiplier '{}' for {} in {}", value, key, path.string());
+			g_penetrationByAmmo[ammo].multiplier = multiplier;
+		}
+
+		// Parses `x:depth, x:depth, ...` with strictly increasing x into a padded knot table.
+		bool TryParseCurve(std::string_view text, PenetrationCurve& outCurve)
+		{
+			std::size_t count = 0;
+			while (!text.empty()) {
+				std::string_view knot;
+				std::string_view rest;
+				if (!Utils::SplitOnce(text, ',', knot, rest)) {
+					knot = Utils::TrimView(text);
+					rest = {};
+				}
+				text = rest;
+				if (knot.empty()) {
 					continue;
 				}
 
-				std::string materialKey = Utils::Trim(key);
-				if (materialKey.empty()) {
-					continue;
+				std::string_view input;
+				std::string_view depth;
+				if (count == PenetrationCurve::kKnots || !Utils::SplitOnce(knot, ':', input, depth)) {
+					return false;
 				}
 
-				materialOverrides[materialKey] = multiplier;
+				float x = 0.0f;
+				float y = 0.0f;
+				if (!Utils::ParseFloat(input, x) || !Utils::ParseFloat(depth, y) || y < 0.0f) {
+					return false;
+				}
+				// -0 and 0 compare equal but hash apart; curves are interned by value.
+				x += 0.0f;
+				y += 0.0f;
+				if (count > 0 && x <= outCurve.x[count - 1]) {
+					return false;
+				}
+
+				outCurve.x[count] = x;
+				outCurve.y[count] = y;
+				++count;
+			}
+
+			if (count == 0) {
+				return false;
+			}
+
+			for (std::size_t i = count; i < PenetrationCurve::kKnots; ++i) {
+				outCurve.x[i] = outCurve.x[count - 1];
+				outCurve.y[i] = outCurve.y[count - 1];
 			}
+			return true;
+		}
 
-			if (!materialOverrides.empty()) {
-				for (auto* material : dataHandler.GetFormArray<RE::BGSMaterialType>()) {
-					if (!material) {
+		std::int32_t InternCurve(const PenetrationCurve& curve)
+		{
+			const auto [it, inserted] = g_curveIndex.try_emplace(curve, static_cast<std::int32_t>(g_curves.size()));
+			if (inserted) {
+				g_curves.push_back(curve);
+			}
+			return it->second;
+		}
+
+		void ApplyAmmoCurve(
+			RE::TESDataHandler& dataHandler,
+			std::string_view pluginName,
+			std::string_view formIDText,
+			std::string_view curveText,
+			const std::filesystem::path& path)
+		{
+			std::uint32_t formID = 0;
+			if (!TryParseFormID(formIDText, formID)) {
+				++g_diagnostics.file.invalidFormIDs;
+				logger::trace("Invalid form ID '{}' in {}", formIDText, path.string());
+				return;
+			}
+
+			PenetrationCurve curve;
+			if (!TryParseCurve(curveText, curve)) {
+				++g_diagnostics.file.invalidValues;
+				logger::trace("Invalid curve '{}' for {}|{} in {}", curveText, pluginName, formIDText, path.string());
+				return;
+			}
+
+			auto* ammo = FormCache::Resolve<RE::TESAmmo>(dataHandler, pluginName, formID);
+			if (!ammo) {
+				if (dataHandler.LookupModByName(pluginName)) {
+					++g_diagnostics.file.unresolvedForms;
+				} else {
+					RecordMissingPlugin(pluginName);
+				}
+				logger::trace("Unable to resolve ammo {}|{:06X} in {}", pluginName, formID, path.string());
+				return;
+			}
+
+			g_penetrationByAmmo[ammo].curve = InternCurve(curve);
+		}
+
+		// Next field of a delimited row; advances `row` past the delimiter.
+		std::string_view NextField(std::string_view& row, char delimiter) noexcept
+		{
+			const auto* found = static_cast<const char*>(std::memchr(row.data(), delimiter, row.size()));
+			const std::size_t length = found ? static_cast<std::size_t>(found - row.data()) : row.size();
+			const std::string_view field = row.substr(0, length);
+			row.remove_prefix(found ? length + 1 : length);
+			return Utils::TrimView(field);
+		}
+
+		enum class RowKind
+		{
+			kIgnored,
+			kHeader,
+			kData,
+			kInvalid
+		};
+
+		std::string_view StripRow(std::string_view row) noexcept
+		{
+			if (!row.empty() && row.back() == '\r') {
+				row.remove_suffix(1);
+			}
+			return row;
+		}
+
+		bool IsIgnoredRow(std::string_view row) noexcept
+		{
+			const std::string_view trimmed = Utils::TrimView(row);
+			return trimmed.empty() || trimmed.front() == '#' || trimmed.front() == ';';
+		}
+
+		// A header names the `Plugin, FormID, Multiplier` columns; anything else in the first row is
+		// data and goes through the usual diagnostics.
+		bool IsHeaderRow(std::string_view row, char delimiter) noexcept
+		{
+			const std::string_view plugin = NextField(row, delimiter);
+			const std::string_view formID = NextField(row, delimiter);
+			const std::string_view value = NextField(row, delimiter);
+			return Utils::IEquals(plugin, "Plugin") &&
+			       (Utils::IEquals(formID, "FormID") || Utils::IEquals(formID, "Form ID")) &&
+			       Utils::IEquals(value, "Multiplier");
+		}
+
+		RowKind ApplyAmmoRow(RE::TESDataHandler& dataHandler, std::string_view row, char delimiter, const std::filesystem::path& path)
+		{
+			const std::string_view pluginName = NextField(row, delimiter);
+			const std::string_view formID = NextField(row, delimiter);
+			const std::string_view value = NextField(row, delimiter);
+			if (pluginName.empty() || formID.empty() || value.empty()) {
+				return RowKind::kInvalid;
+			}
+
+			ApplyAmmoEntry(dataHandler, pluginName, formID, value, path);
+			return RowKind::kData;
+		}
+
+		// Streams a CSV or TSV table of `Plugin, FormID, Multiplier` rows in fixed-size chunks. Rows
+		// are found with memchr; a row cut by the chunk boundary is carried into the next read. A
+		// header row is skipped only when it names the expected columns, and a leading UTF-8 byte
+		// order mark is dropped. Quoted fields are not supported.
+		void LoadTable(const std::filesystem::path& path, char delimiter, RE::TESDataHandler& dataHandler)
+		{
+			auto& profile = LoadProfile::AddFile(path);
+			std::ifstream file(path, std::ios::binary);
+			if (!file) {
+				logger::warn("Failed to load penetration table: {}", path.string());
+				return;
+			}
+
+			constexpr std::size_t kChunkSize = 1 << 20;
+			Memory::Vector<Memory::Tag::kConfig, char> buffer(kChunkSize);
+			std::size_t carried = 0;
+			std::size_t rows = 0;
+			bool firstRow = true;
+			bool firstChunk = true;
+
+			const auto classifyRow = [&](std::string_view row) {
+				if (IsIgnoredRow(row)) {
+					return RowKind::kIgnored;
+				}
+				if (std::exchange(firstRow, false) && IsHeaderRow(row, delimiter)) {
+					return RowKind::kHeader;
+				}
+				return ApplyAmmoRow(dataHandler, row, delimiter, path);
+			};
+
+			const auto processRow = [&](std::string_view row) {
+				row = StripRow(row);
+				switch (classifyRow(row)) {
+				case RowKind::kInvalid:
+					++g_diagnostics.file.invalidKeys;
+					logger::trace("Invalid penetration table row '{}' in {}", row, path.string());
+					[[fallthrough]];
+				case RowKind::kData:
+					++rows;
+					break;
+				default:
+					break;
+				}
+			};
+
+			for (;;) {
+				{
+					LoadProfile::ScopedTimer timer(profile.readMs);
+					file.read(buffer.data() + carried, static_cast<std::streamsize>(buffer.size() - carried));
+				}
+				profile.bytes += static_cast<std::uintmax_t>(file.gcount());
+				const std::size_t available = carried + static_cast<std::size_t>(file.gcount());
+				if (available == 0) {
+					break;
+				}
+
+				LoadProfile::ScopedTimer timer(profile.resolveMs);
+				const char* cursor = buffer.data();
+				const char* const end = buffer.data() + available;
+				if (std::exchange(firstChunk, false) && std::string_view(cursor, available).starts_with(kUtf8Bom)) {
+					cursor += kUtf8Bom.size();
+				}
+				while (cursor < end) {
+					const auto* newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor)));
+					if (!newline) {
+						break;
+					}
+					processRow({ cursor, static_cast<std::size_t>(newline - cursor) });
+					cursor = newline + 1;
+				}
+
+				carried = static_cast<std::size_t>(end - cursor);
+				if (!file) {
+					if (carried > 0) {
+						processRow({ cursor, carried });
+					}
+					break;
+				}
+
+				if (carried == buffer.size()) {
+					logger::warn("Penetration table row longer than {} bytes in {}; stopping", kChunkSize, path.string());
+					break;
+				}
+				std::memmove(buffer.data(), cursor, carried);
+			}
+
+			profile.entries = rows;
+			logger::info(FMT_STRING("Read {} ammunition rows from {}"), rows, path.string());
+			ReportFileDiagnostics(path);
+		}
+
+		void LoadFile(const std::filesystem::path& path, RE::TESDataHandler& dataHandler, PendingMaterials& materials)
+		{
+			auto& profile = LoadProfile::AddFile(path);
+
+			std::string contents;
+			{
+				LoadProfile::ScopedTimer timer(profile.readMs);
+				std::ifstream file(path, std::ios::binary);
+				if (!file) {
+					logger::warn("Failed to load penetration config: {}", path.string());
+					return;
+				}
+				contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+			}
+			profile.bytes = contents.size();
+
+			CSimpleIniA ini(true, false, false);
+			{
+				LoadProfile::ScopedTimer timer(profile.parseMs);
+				if (ini.LoadData(contents.data(), contents.size()) < 0) {
+					logger::warn("Failed to load penetration config: {}", path.string());
+					return;
+				}
+				LoadGeneral(ini, path);
+			}
+
+			CSimpleIniA::TNamesDepend ammoKeys;
+			{
+				LoadProfile::ScopedTimer timer(profile.sortMs);
+				ini.GetAllKeys(kAmmoSection.data(), ammoKeys);
+				ammoKeys.sort(CSimpleIniA::Entry::LoadOrder());
+			}
+
+			profile.entries = ammoKeys.size();
+			{
+				LoadProfile::ScopedTimer timer(profile.resolveMs);
+				for (const auto& entry : ammoKeys) {
+					const char* key = entry.pItem;
+					if (!key) {
 						continue;
 					}
 
-					const char* editorID = material->GetFormEditorID();
-					if (!editorID || *editorID == '\0') {
+					const char* value = ini.GetValue(kAmmoSection.data(), key);
+					if (!value) {
 						continue;
 					}
 
-					auto it = materialOverrides.find(editorID);
-					if (it != materialOverrides.end()) {
-						logger::warn("Added {} mult: {:.2f}", editorID, it->second);
-						g_penetrationByMaterial[material] = it->second;
+					std::string_view pluginName;
+					std::string_view remainder;
+					if (!Utils::SplitOnce(key, '|', pluginName, remainder) || pluginName.empty() || remainder.empty()) {
+						++g_diagnostics.file.invalidKeys;
+						logger::trace("Invalid penetration config key '{}' in {}", key, path.string());
+						continue;
 					}
+
+					ApplyAmmoEntry(dataHandler, pluginName, remainder, value, path);
+				}
+
+				CSimpleIniA::TNamesDepend curveKeys;
+				ini.GetAllKeys(kAmmoCurveSection.data(), curveKeys);
+				curveKeys.sort(CSimpleIniA::Entry::LoadOrder());
+				profile.entries += curveKeys.size();
+				for (const auto& entry : curveKeys) {
+					const char* key = entry.pItem;
+					const char* value = key ? ini.GetValue(kAmmoCurveSection.data(), key) : nullptr;
+					if (!value) {
+						continue;
+					}
+
+					std::string_view pluginName;
+					std::string_view remainder;
+					if (!Utils::SplitOnce(key, '|', pluginName, remainder) || pluginName.empty() || remainder.empty()) {
+						++g_diagnostics.file.invalidKeys;
+						logger::trace("Invalid penetration config key '{}' in {}", key, path.string());
+						continue;
+					}
+
+					ApplyAmmoCurve(dataHandler, pluginName, remainder, value, path);
 				}
 			}
+
+			{
+				LoadProfile::ScopedTimer timer(profile.materialsMs);
+				ReadMaterialSection(ini, kMaterialSection, path, materials.multipliers);
+				ReadMaterialSection(ini, kCriticalAngleSection, path, materials.criticalAngles);
+			}
+			ReportFileDiagnostics(path);
 		}
 	}
 
 	void LoadConfig()
 	{
 		g_penetrationByAmmo.clear();
+		g_curves.clear();
+		g_curveIndex.clear();
 		g_penetrationByMaterial.clear();
+		g_criticalCosByMaterial.clear();
+		g_settings = {};
+		g_diagnostics = {};
+		g_eligibleAmmo.built.store(false, std::memory_order_release);
+		g_defaultCriticalCos = CriticalCosine(g_settings.criticalAngle);
 
 		auto* dataHandler = RE::TESDataHandler::GetSingleton();
 		if (!dataHandler) {
@@ -178,37 +752,101 @@ namespace Penetration
 		const std::filesystem::path configDirectory{ "Data\\F4SE\\Plugins\\PenetrationSystem\\" };
 		if (!std::filesystem::exists(configDirectory)) {
 			logger::warn("Penetration config directory does not exist: {}", configDirectory.string());
+			BuildEligibility(*dataHandler);
 			return;
 		}
 
-		for (const auto& entry : std::filesystem::directory_iterator(configDirectory)) {
-			if (!entry.is_regular_file()) {
-				continue;
+		LoadProfile::Begin();
+
+		std::vector<std::filesystem::path> files;
+		{
+			LoadProfile::ScopedTimer timer(LoadProfile::PhaseTime(LoadProfile::Phase::kDirectoryScan));
+			for (const auto& entry : std::filesystem::directory_iterator(configDirectory)) {
+				if (entry.is_regular_file()) {
+					files.push_back(entry.path());
+				}
 			}
+		}
 
-			auto extension = entry.path().extension().string();
-			std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
-			if (extension != ".ini") {
-				continue;
+		{
+			LoadProfile::ScopedTimer timer(LoadProfile::PhaseTime(LoadProfile::Phase::kFormCache));
+			FormCache::Begin(*dataHandler);
+		}
+
+		PendingMaterials materials;
+		for (const auto& path : files) {
+			const auto extension = path.extension().string();
+			if (Utils::IEquals(extension, ".ini")) {
+				LoadFile(path, *dataHandler, materials);
+			} else if (Utils::IEquals(extension, ".csv")) {
+				LoadTable(path, ',', *dataHandler);
+			} else if (Utils::IEquals(extension, ".tsv")) {
+				LoadTable(path, '\t', *dataHandler);
 			}
+		}
 
-			LoadFile(entry.path(), *dataHandler);
+		{
+			LoadProfile::ScopedTimer timer(LoadProfile::PhaseTime(LoadProfile::Phase::kFormCache));
+			FormCache::Save();
+		}
+		{
+			LoadProfile::ScopedTimer timer(LoadProfile::PhaseTime(LoadProfile::Phase::kMaterialScan));
+			ResolveMaterials(*dataHandler, materials);
+		}
+		ReportMissingPlugins();
+
+		ClampSettings();
+		g_defaultCriticalCos = CriticalCosine(g_settings.criticalAngle);
+		{
+			LoadProfile::ScopedTimer timer(LoadProfile::PhaseTime(LoadProfile::Phase::kTableBuild));
+			BuildEligibility(*dataHandler);
 		}
 
 		logger::info(
-			FMT_STRING("Loaded penetration multipliers for {} ammunition forms and {} materials"),
+			FMT_STRING("Loaded penetration multipliers for {} ammunition forms ({} distinct curves) and {} materials ({} material overrides applied)"),
 			g_penetrationByAmmo.size(),
-			g_penetrationByMaterial.size());
+			g_curves.size(),
+			g_penetrationByMaterial.size(),
+			g_diagnostics.materialsApplied);
+		LoadProfile::Write();
 	}
 
-	float GetPenetrationMultiplier(const RE::TESAmmo* ammo) noexcept
+	const Settings& GetSettings() noexcept
+	{
+		return g_settings;
+	}
+
+	AmmoPenetration GetAmmoPenetration(const RE::TESAmmo* ammo) noexcept
 	{
 		if (!ammo) {
-			return 1.0f;
+			return {};
 		}
 
 		const auto it = g_penetrationByAmmo.find(ammo);
-		return it != g_penetrationByAmmo.end() ? it->second : 1.0f;
+		if (it == g_penetrationByAmmo.end()) {
+			return {};
+		}
+
+		const auto& entry = it->second;
+		return { entry.multiplier, entry.curve >= 0 ? std::addressof(g_curves[static_cast<std::size_t>(entry.curve)]) : nullptr };
+	}
+
+	// Counts the knots at or below `input` (a compare-and-add over the whole table, which compilers
+	// vectorize), then interpolates within the selected segment with a clamped factor, so inputs
+	// outside the curve hold the end depths.
+	float EvaluateCurve(const PenetrationCurve& curve, float input) noexcept
+	{
+		std::size_t above = 0;
+		for (std::size_t i = 0; i < PenetrationCurve::kKnots; ++i) {
+			above += static_cast<std::size_t>(input >= curve.x[i]);
+		}
+
+		const std::size_t upper = std::clamp<std::size_t>(above, 1, PenetrationCurve::kKnots - 1);
+		const std::size_t lower = upper - 1;
+		// Padding knots repeat the last one, so past the end the segment has zero width.
+		const float width = curve.x[upper] - curve.x[lower];
+		const float t = width > 0.0f ? std::clamp((input - curve.x[lower]) / width, 0.0f, 1.0f) : 1.0f;
+		return curve.y[lower] + (curve.y[upper] - curve.y[lower]) * t;
 	}
 
 	float GetMaterialMultiplier(const RE::BGSMaterialType* material) noexcept
@@ -220,4 +858,23 @@ namespace Penetration
 		const auto it = g_penetrationByMaterial.find(material);
 		return it != g_penetrationByMaterial.end() ? it->second : 1.0f;
 	}
+
+	float GetCriticalAngleCosine(const RE::BGSMaterialType* material) noexcept
+	{
+		if (!material) {
+			return g_defaultCriticalCos;
+		}
+
+		const auto it = g_criticalCosByMaterial.find(material);
+		return it != g_criticalCosByMaterial.end() ? it->second : g_defaultCriticalCos;
+	}
+
+	bool IsPenetrationCandidate(const RE::TESAmmo* ammo) noexcept
+	{
+		if (!ammo || !g_eligibleAmmo.built.load(std::memory_order_acquire)) {
+			return true;
+		}
+
+		return g_eligibleAmmo.Test(ammo->formID);
+	}
 }
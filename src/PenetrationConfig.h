@@ -1,10 +1,56 @@
 #pragma once
 
+#include <array>
+
 namespace Penetration
 {
+	struct Settings
+	{
+		std::uint32_t thicknessCacheCapacity{ 2048 };
+		float coherenceTolerance{ 8.0f };
+		float coherenceAngle{ 4.0f };
+		float coherenceMinConfidence{ 0.25f };
+		std::uint32_t coherenceLifetimeMs{ 50 };
+		std::uint32_t maxLayers{ 4 };
+		float layerSearchDistance{ 64.0f };
+		float criticalAngle{ 90.0f };
+		std::uint32_t pendingShooterLifetimeMs{ 10000 };
+		std::uint32_t beamMemoLifetimeMs{ 250 };
+		std::uint32_t raycastBudget{ 64 };
+		std::uint32_t deferredQueueSize{ 128 };
+		std::uint32_t deferredLatencyMs{ 100 };
+		bool asyncResolution{ false };
+		std::uint32_t asyncWorkers{ 0 };
+		bool deterministicWorkers{ false };
+	};
+
+	// Penetration depth as a function of damage scaled by power, compiled from an [AmmoCurve]
+	// entry. Knot inputs are strictly increasing; unused knots repeat the last knot so evaluation is
+	// the same fixed sequence of operations for every curve.
+	struct alignas(32) PenetrationCurve
+	{
+		static constexpr std::size_t kKnots = 8;
+
+		std::array<float, kKnots> x{};
+		std::array<float, kKnots> y{};
+	};
+
+	struct AmmoPenetration
+	{
+		float multiplier{ 1.0f };
+		const PenetrationCurve* curve{ nullptr };
+	};
+
 	void LoadConfig();
-	float GetPenetrationMultiplier(const RE::TESAmmo* ammo) noexcept;
+	// Rewritten only by LoadConfig on the game thread; worker jobs run while the game thread waits
+	// for them, so they never observe a reload.
+	const Settings& GetSettings() noexcept;
+
+	AmmoPenetration GetAmmoPenetration(const RE::TESAmmo* ammo) noexcept;
+	float EvaluateCurve(const PenetrationCurve& curve, float input) noexcept;
 	float GetMaterialMultiplier(const RE::BGSMaterialType* material) noexcept;
+	float GetCriticalAngleCosine(const RE::BGSMaterialType* material) noexcept;
+	bool IsPenetrationCandidate(const RE::TESAmmo* ammo) noexcept;
 }
 namespace RE
 {
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "MemoryTracking.h"
+#include "Utils.h"
+
+#include <RE/Bethesda/BSPointerHandle.h>
+#include <RE/Bethesda/Projectiles.h>
+
+namespace Penetration
+{
+	struct PenetrationCurve;
+
+	// The parts of an ImpactData the pipeline reads, plus the per-impact values derived from
+	// config. `along` is the impact's position projected on the travel direction. `depth` is the
+	// penetration depth at the snapshot's power; `depthScale` is the ammo and material multiplier
+	// it was derived with, so a chain can re-derive it at the power it carries. The world
+	// transform of the collidee's 3D root is copied on the game thread so the exit caches never
+	// dereference the ref, and it follows animated and keyframed bodies (doors) that move without
+	// changing the ref's placement. The collision body and 3D root are identities for cache
+	// validation and are never dereferenced.
+	struct ImpactSample
+	{
+		RE::NiPoint3 location;
+		RE::NiPoint3 normal;
+		RE::ObjectRefHandle collidee;
+		RE::NiTransform collideeWorld;
+		const RE::TESObjectCELL* collideeCell{ nullptr };
+		const void* collideeRoot{ nullptr };
+		std::uintptr_t body{ 0 };
+		RE::BGSMaterialType* materialType{ nullptr };
+		float along{ 0.0f };
+		float depth{ 0.0f };
+		float depthScale{ 1.0f };
+		float criticalCos{ 0.0f };
+	};
+
+	// A beam impact in the beam memo: the beam, the collidee and the impact location rounded to
+	// whole units. A zero beam marks a snapshot whose outcome is not memoized.
+	struct BeamImpactKey
+	{
+		std::uint32_t beam{ 0 };
+		std::uint32_t collidee{ 0 };
+		std::int32_t location[3]{};
+
+		bool operator==(const BeamImpactKey& other) const noexcept
+		{
+			return beam == other.beam &&
+			       collidee == other.collidee &&
+			       location[0] == other.location[0] && location[1] == other.location[1] && location[2] == other.location[2];
+		}
+	};
+
+	// Immutable copy of everything needed to resolve a penetration and launch its continuation,
+	// so the work can outlive the source projectile (deferred to a later frame). `actorCause` is
+	// only valid while the source is alive and is cleared before the snapshot is deferred. The
+	// cell and spell may be unloaded between frames, so a deferred snapshot re-resolves them from
+	// their form IDs on every resume.
+	struct PenetrationSnapshot
+	{
+		RE::TESObjectCELL* cell{ nullptr };
+		RE::TESFormID cellID{ 0 };
+		RE::TESFormID spellID{ 0 };
+		RE::BGSProjectile* projectileBase{ nullptr };
+		RE::ObjectRefHandle shooter;
+		decltype(RE::Projectile::weaponSource) weaponSource;
+		RE::TESAmmo* ammo{ nullptr };
+		decltype(RE::Projectile::equipIndex) equipIndex;
+		decltype(RE::Projectile::spell) spell{ nullptr };
+		decltype(RE::Projectile::avEffect) avEffect{ nullptr };
+		decltype(RE::Projectile::damage) damage{};
+		float totalDamage{ 0.0f };
+		// Owned by the config, which is only reloaded once deferred and queued work is cleared.
+		const PenetrationCurve* curve{ nullptr };
+		RE::ActorCause* actorCause{ nullptr };
+		Utils::PickFilter pickFilter;
+		bool playerShot{ false };
+		float playerDistanceSq{ 0.0f };
+		float power{ 0.0f };
+		RE::NiPoint3 direction;
+		// The beam memo entry to settle once a deferred or queued resolution finishes.
+		BeamImpactKey beamImpact;
+		Memory::Vector<Memory::Tag::kPendingWork, ImpactSample> impacts;
+	};
+}
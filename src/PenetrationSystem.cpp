@@ -1,17 +1,34 @@
 #include "PenetrationSystem.h"
 
+#include "MemoryTracking.h"
+#include "PendingShooters.h"
+#include "PenetrationCache.h"
 #include "PenetrationConfig.h"
+#include "PenetrationSnapshot.h"
+#include "PenetrationTask.h"
+#include "Scheduler.h"
 #include "Utils.h"
+#include "WorkerPool.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
+#include <coroutine>
+#include <latch>
 #include <limits>
+#include <memory_resource>
 #include <mutex>
+#include <optional>
 #include <string_view>
-#include <unordered_map>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <REL/Relocation.h>
 
+#include <RE/Bethesda/MagicItems.h>
+#include <RE/Bethesda/PlayerCharacter.h>
 #include <RE/Bethesda/Projectiles.h>
 #include <RE/Bethesda/TESDataHandler.h>
 #include <RE/Bethesda/TESForms.h>
@@ -22,34 +39,35 @@ namespace Penetration
 {
     namespace
     {
-        using ProjectileProcessFn = bool (*)(RE::Projectile*);
-        using MissileProcessFn = bool (*)(RE::MissileProjectile*);
-        using BeamProcessFn = bool (*)(RE::BeamProjectile*);
-
-        std::uintptr_t g_projectileProcessImpactsOriginal = 0;
-        std::uintptr_t g_missileProcessImpactsOriginal = 0;
-        std::uintptr_t g_beamProcessImpactsOriginal = 0;
-
-        using ProjectileHandleId = RE::ProjectileHandle::native_handle_type;
-        using PendingShooterMap = std::unordered_map<ProjectileHandleId, RE::ObjectRefHandle>;
+		// Per-class behaviour of the ProcessImpacts hook, resolved at compile time.
+		//   kPenetrates      - run the penetration pipeline at all
+		//   kClearsBeamFlag  - spawned projectiles need the beam 0x20000000 flag cleared after launch
+		//   kMemoizesImpacts - the same impact can be reported on consecutive frames; reuse the outcome
+		template <class T>
+		struct ProjectileTraits
+		{
+			static constexpr bool kPenetrates = true;
+			static constexpr bool kClearsBeamFlag = false;
+			static constexpr bool kMemoizesImpacts = false;
+		};
 
-        PendingShooterMap g_pendingShooters;
-		std::mutex g_pendingShootersMutex;
+		template <>
+		struct ProjectileTraits<RE::BeamProjectile>
+		{
+			static constexpr bool kPenetrates = true;
+			static constexpr bool kClearsBeamFlag = true;
+			static constexpr bool kMemoizesImpacts = true;
+		};
 
         void QueuePendingShooterAssignment(RE::ProjectileHandle handle, RE::ObjectRefHandle shooter)
         {
-            if (!handle || !shooter) {
-                return;
-            }
-
-            const ProjectileHandleId key = handle.native_handle();
-            std::scoped_lock lock(g_pendingShootersMutex);
-            g_pendingShooters[key] = shooter;
+            PendingShooters::Queue(handle, shooter);
+            Scheduler::RequestTick();
         }
 
         void ApplyPendingShooter(RE::Projectile* projectile)
         {
-            if (!projectile) {
+            if (!projectile || PendingShooters::Empty()) {
                 return;
             }
 
@@ -58,20 +76,10 @@ namespace Penetration
                 return;
             }
 
-            const ProjectileHandleId key = handle.native_handle();
             RE::ObjectRefHandle shooter;
-
-            {
-                std::scoped_lock lock(g_pendingShootersMutex);
-                auto it = g_pendingShooters.find(key);
-                if (it == g_pendingShooters.end()) {
-                    return;
-                }
-                shooter = it->second;
-                g_pendingShooters.erase(it);
+            if (PendingShooters::Claim(handle, shooter)) {
+                projectile->shooter = shooter;
             }
-
-            projectile->shooter = shooter;
         }
 
         RE::BGSProjectile* GetProjectileBase(RE::Projectile& projectile)
@@ -80,33 +88,23 @@ namespace Penetration
             return baseObject ? baseObject->As<RE::BGSProjectile>() : nullptr;
         }
 
-        float CalculatePenetrationDepth(
-            const RE::Projectile& projectile,
-            float ammoMultiplier,
-            float materialMultiplier)
-        {
-			float damage = projectile.GetTotalDamage();
-            const float combinedMultiplier = ammoMultiplier * materialMultiplier;
-			float depth = damage / 2.0f * combinedMultiplier;
-
-			logger::info(
-				FMT_STRING("[Penetration] Calculation depth {} (power {:.2f} damage {:.2f}, ammo {:.2f}, material {:.2f})"),
-				depth,
-				projectile.power,
-				damage,
-				ammoMultiplier,
-				materialMultiplier);
-			return depth;
-        }
+		// `depthScale` is the ammo multiplier times the impact's material multiplier. A depth curve
+		// is evaluated at the damage scaled by `power`, the power the shot has left at the impact.
+		float CalculatePenetrationDepth(const PenetrationSnapshot& snapshot, float depthScale, float power)
+		{
+			const float baseDepth = snapshot.curve ? EvaluateCurve(*snapshot.curve, snapshot.totalDamage * power) : snapshot.totalDamage / 2.0f;
+			return baseDepth * depthScale;
+		}
 
-        bool SpawnPenetratedProjectile(RE::Projectile& source, const Utils::RaycastHit& hit, const RE::NiPoint3& launchDir, float remainingPower)
+        template <class T>
+        bool SpawnPenetratedProjectile(const PenetrationSnapshot& source, const Utils::RaycastHit& hit, const RE::NiPoint3& launchDir, float remainingPower)
         {
-            auto* cell = source.parentCell;
+            auto* cell = source.cell;
             if (!cell) {
                 return false;
             }
 
-            auto* projectileBase = GetProjectileBase(source);
+            auto* projectileBase = source.projectileBase;
             if (!projectileBase) {
                 return false;
             }
@@ -126,7 +124,7 @@ namespace Penetration
 			};
 			projData.origin = hit.point + launchDir * (projectileBase->data.collisionRadius + 4.f);
 			projData.projectileBase = projectileBase;
-			projData.fromAmmo = source.ammoSource;
+			projData.fromAmmo = source.ammo;
 			projData.equipIndex = source.equipIndex;
 			projData.xAngle = launchAngles.x;
 			projData.zAngle = launchAngles.z;
@@ -149,8 +147,12 @@ namespace Penetration
 
 			spawned->avEffect = source.avEffect;
 			spawned->damage = source.damage;
-			spawned->SetActorCause(source.GetActorCause());
-			if (spawned->IsBeamProjectile()) {
+			if (source.actorCause) {
+				spawned->SetActorCause(source.actorCause);
+			} else if (auto shooter = source.shooter.get()) {
+				spawned->SetActorCause(shooter->GetActorCause());
+			}
+			if constexpr (ProjectileTraits<T>::kClearsBeamFlag) {
 				auto* beam = static_cast<RE::BeamProjectile*>(spawned);
 				beam->flags &= ~(0x20000000);
 			}
@@ -162,171 +164,1044 @@ namespace Penetration
             return true;
         }
 
-        bool TryHandlePenetration(RE::Projectile* projectile)
-        {
-            if (!projectile) {
-                return false;
+		using SpawnFn = bool (*)(const PenetrationSnapshot&, const Utils::RaycastHit&, const RE::NiPoint3&, float);
+
+		constexpr float kSurfaceOffset = 0.5f;
+		constexpr float kMinLayerThickness = 1.5f;
+
+		enum class Resolution
+		{
+			kStopped,
+			kPenetrated,
+			kOverBudget
+		};
+
+		// Everything the pipeline reads comes from the snapshot, which is captured on the game
+		// thread; nothing here dereferences a game object except the cell for the raycast itself.
+		struct PenetrationContext
+		{
+			const PenetrationSnapshot& snapshot;
+		};
+
+		// One forward all-hits cast shared by every pending impact of a projectile. Impacts lie on
+		// the same path, so the sorted hit list covers all of their exits at once; `begin`/`end` are
+		// the covered interval measured along the travel direction.
+		struct ExitBatch
+		{
+			std::pmr::vector<Utils::RaycastHit> hits{ Utils::ScratchResource() };
+			float begin{ 0.0f };
+			float end{ -1.0f };
+
+			bool Covers(float from, float to) const noexcept { return begin <= from && to <= end; }
+		};
+
+		bool CastRay(const PenetrationContext& context, const RE::NiPoint3& start, const RE::NiPoint3& end, RE::bhkPickData& pickData, Utils::RaycastHit& hit)
+		{
+			Scheduler::ChargeRaycast();
+			const auto& snapshot = context.snapshot;
+			return Utils::PerformRaycast(snapshot.cell, snapshot.pickFilter, start, end, pickData, hit);
+		}
+
+		void CastExitBatch(const PenetrationContext& context, const ImpactSample& entry, float reach, ExitBatch& batch)
+		{
+			const RE::NiPoint3& direction = context.snapshot.direction;
+			const RE::NiPoint3 start = entry.location + direction * kSurfaceOffset;
+			const RE::NiPoint3 end = entry.location + direction * (reach - entry.along);
+
+			batch.hits.clear();
+			batch.begin = entry.along + kSurfaceOffset;
+			batch.end = reach;
+
+			Utils::PickScope pick;
+			Utils::RaycastHit closest{};
+			if (CastRay(context, start, end, pick.get(), closest)) {
+				Utils::GatherHits(pick.get(), start, batch.hits);
 			}
 
-            if (projectile->explosion) {
-                return false;
-            }
+			logger::debug(
+				FMT_STRING("[Penetration] Forward batch ray covering {:.2f} units hit count {}"),
+				reach - entry.along,
+				batch.hits.size());
+		}
 
-            auto& impacts = projectile->impacts;
-            RE::Projectile::ImpactData* impactData = nullptr;
-            for (auto& impact : impacts) {
-                if (!impact.processed) {
-                    impactData = std::addressof(impact);
-                    break;
-                }
-            }
+		bool FindExitInBatch(const PenetrationContext& context, const ExitBatch& batch, const ImpactSample& entry, Utils::RaycastHit& hit)
+		{
+			const Utils::RaycastHit* fallback = nullptr;
+			for (const auto& candidate : batch.hits) {
+				const float along = context.snapshot.direction.Dot(candidate.point);
+				if (along <= entry.along) {
+					continue;
+				}
+				if (along > entry.along + entry.depth) {
+					break;
+				}
 
-            if (!impactData) {
-                return false;
-            }
+				if (entry.location.GetDistance(candidate.point) >= kMinLayerThickness) {
+					hit = candidate;
+					return true;
+				}
+				if (!fallback) {
+					fallback = std::addressof(candidate);
+				}
+			}
 
-            auto* projectileBase = GetProjectileBase(*projectile);
-            const float ammoMultiplier = Penetration::GetPenetrationMultiplier(projectile->ammoSource);
-            const float materialMultiplier = Penetration::GetMaterialMultiplier(impactData->materialType);
-			const float penetrationDepth = CalculatePenetrationDepth(*projectile, ammoMultiplier, materialMultiplier);
-			if (impactData->materialType) {
-				logger::info(
-					FMT_STRING("[Penetration] Impact Material: {}"),
-					impactData->materialType->GetFormEditorID());
+			if (fallback) {
+				hit = *fallback;
+				return true;
 			}
-            if (penetrationDepth <= 0.0f) {
-                return false;
+			return false;
+		}
+
+		bool MeasureExitReverse(const PenetrationContext& context, const ImpactSample& entry, Utils::RaycastHit& hit)
+		{
+			const RE::NiPoint3& direction = context.snapshot.direction;
+			const RE::NiPoint3 start = entry.location + direction * entry.depth;
+			const RE::NiPoint3 end = entry.location + direction * kSurfaceOffset;
+
+			Utils::PickScope pick;
+			auto& pickData = pick.get();
+			if (!CastRay(context, start, end, pickData, hit)) {
+				logger::debug(FMT_STRING("[Penetration] Reverse ray also missed"));
+				return false;
+			}
+
+			const auto hitCount = pickData.GetAllCollectorRayHitSize();
+			Utils::RaycastHit realHit = hit;
+			if (hitCount > 0 && Utils::SelectRealExit(pickData, entry.location, realHit)) {
+				hit = realHit;
+			}
+
+			logger::debug(
+				FMT_STRING("[Penetration] Reverse ray hit count {} exit ({:.2f}, {:.2f}, {:.2f})"),
+				hitCount,
+				hit.point.x,
+				hit.point.y,
+				hit.point.z);
+			return true;
+		}
+
+		// `outReused` is set when the exit came from the thickness or coherence cache, in which case
+		// no Havok query was made.
+		Resolution ResolveExit(const PenetrationContext& context, const ImpactSample& entry, float reach, ExitBatch& batch, Utils::RaycastHit& hit, bool& outReused)
+		{
+			const RE::NiPoint3& direction = context.snapshot.direction;
+			float cachedThickness = 0.0f;
+			outReused = true;
+			if (Cache::LookupCoherent(entry, direction, hit, cachedThickness)) {
+				logger::debug(
+					FMT_STRING("[Penetration] Reprojected nearby exit thickness {:.2f} exit ({:.2f}, {:.2f}, {:.2f})"),
+					cachedThickness,
+					hit.point.x,
+					hit.point.y,
+					hit.point.z);
+				return Resolution::kPenetrated;
+			}
+
+			if (Cache::LookupExit(entry, direction, hit, cachedThickness)) {
+				logger::debug(
+					FMT_STRING("[Penetration] Cached exit thickness {:.2f} exit ({:.2f}, {:.2f}, {:.2f})"),
+					cachedThickness,
+					hit.point.x,
+					hit.point.y,
+					hit.point.z);
+				Cache::StoreCoherent(entry, direction, hit, cachedThickness);
+				return Resolution::kPenetrated;
+			}
+
+			outReused = false;
+			const bool covered = batch.Covers(entry.along + kSurfaceOffset, entry.along + entry.depth);
+			if (!covered || batch.hits.empty()) {
+				// A batch miss needs the reverse cast, so either way at least one more ray is required.
+				if (!Scheduler::HasBudget()) {
+					return Resolution::kOverBudget;
+				}
+			}
+
+			if (!covered) {
+				CastExitBatch(context, entry, std::max(reach, entry.along + entry.depth), batch);
+			}
+
+			if (!FindExitInBatch(context, batch, entry, hit)) {
+				if (!Scheduler::HasBudget()) {
+					return Resolution::kOverBudget;
+				}
+				if (!MeasureExitReverse(context, entry, hit)) {
+					return Resolution::kStopped;
+				}
+			}
+
+			const float thickness = entry.location.GetDistance(hit.point);
+			Cache::StoreExit(entry, direction, hit, thickness);
+			Cache::StoreCoherent(entry, direction, hit, thickness);
+			return Resolution::kPenetrated;
+		}
+
+		// Follows the ray past the first exit through further entry/exit pairs while depth remains,
+		// so stacked thin geometry costs one launch instead of one per layer. Returns the depth
+		// left after the last layer that was fully crossed; `exit` is moved to that layer's exit.
+		// Only static geometry is crossed: the walk stops in front of anything else (actors,
+		// clutter) so the spawned projectile hits it and the game applies damage and effects.
+		// Skipped when the frame budget is spent: the spawned projectile then meets the next layer
+		// through the normal impact path.
+		float WalkAdditionalLayers(const PenetrationContext& context, float remainingDepth, Utils::RaycastHit& exit)
+		{
+			const auto& settings = GetSettings();
+			if (settings.maxLayers <= 1 || remainingDepth <= kMinLayerThickness || !Scheduler::HasBudget()) {
+				return remainingDepth;
+			}
+
+			const RE::NiPoint3& direction = context.snapshot.direction;
+			const RE::NiPoint3 start = exit.point + direction * kSurfaceOffset;
+			const RE::NiPoint3 end = exit.point + direction * (remainingDepth + settings.layerSearchDistance);
+
+			Utils::PickScope pick;
+			Utils::RaycastHit closest{};
+			if (!CastRay(context, start, end, pick.get(), closest)) {
+				return remainingDepth;
+			}
+
+			std::pmr::vector<Utils::RaycastHit> hits{ Utils::ScratchResource() };
+			Utils::GatherHits(pick.get(), start, hits);
+
+			std::uint32_t layers = 1;
+			std::size_t index = 0;
+			while (layers < settings.maxLayers && index < hits.size()) {
+				const auto& entry = hits[index];
+				if (!Utils::IsStaticGeometry(entry.layer) || exit.point.GetDistance(entry.point) > settings.layerSearchDistance) {
+					break;
+				}
+
+				std::size_t exitIndex = index + 1;
+				while (exitIndex < hits.size() && entry.point.GetDistance(hits[exitIndex].point) < kMinLayerThickness) {
+					++exitIndex;
+				}
+				if (exitIndex >= hits.size() || !Utils::IsStaticGeometry(hits[exitIndex].layer)) {
+					break;
+				}
+
+				const float thickness = entry.point.GetDistance(hits[exitIndex].point);
+				if (thickness > remainingDepth) {
+					break;
+				}
+
+				remainingDepth -= thickness;
+				exit = hits[exitIndex];
+				index = exitIndex + 1;
+				++layers;
+
+				logger::debug(
+					FMT_STRING("[Penetration] Layer {} thickness {:.2f} exit ({:.2f}, {:.2f}, {:.2f})"),
+					layers,
+					thickness,
+					exit.point.x,
+					exit.point.y,
+					exit.point.z);
 			}
-			if (projectile->ammoSource) {
-				logger::info("[Penetration] Ammo : {} (FormID {:08X}) - Projectile FormID {:08X} col {:.2f} scale {:.2f}",
-					projectile->ammoSource->fullName.c_str(), projectile->ammoSource->formID,
-					projectile->ammoSource->data.projectile->formID, projectileBase->data.collisionRadius, projectile->scale);
+
+			return remainingDepth;
+		}
+
+		// Grazing hits turn a short nominal depth into a long path through the material, so they
+		// are rejected before any lookup or raycast. The game then resolves the impact normally.
+		bool IsGrazingImpact(const ImpactSample& impact, const RE::NiPoint3& direction)
+		{
+			const float normalLengthSq = impact.normal.Dot(impact.normal);
+			if (normalLengthSq <= std::numeric_limits<float>::epsilon()) {
+				return false;
 			}
 
-            logger::info(
-                FMT_STRING("[Penetration] Impact at ({:.2f}, {:.2f}, {:.2f})"),
-                impactData->location.x,
-                impactData->location.y,
-                impactData->location.z);
-			
-			float pitch = projectile->data.angle.x;
-			float yaw = projectile->data.angle.z;
+			const float incidence = -direction.Dot(impact.normal) / std::sqrt(normalLengthSq);
+			const float criticalCos = impact.criticalCos;
+			if (incidence >= criticalCos) {
+				return false;
+			}
+
+			logger::debug(
+				FMT_STRING("[Penetration] Grazing impact rejected (cos {:.3f} < {:.3f})"),
+				incidence,
+				criticalCos);
+			return true;
+		}
+
+		// Copies the projectile state and every unprocessed impact, ordered along the travel
+		// direction, with their config-derived depths. Also resolves on the game thread everything
+		// the pipeline would otherwise look up through handles: the pick filter, the shooter's
+		// priority and the collidees' world transforms. Only reads config; no Havok queries.
+		bool CaptureSnapshot(RE::Projectile& projectile, PenetrationSnapshot& snapshot)
+		{
+			float pitch = projectile.data.angle.x;
+			float yaw = projectile.data.angle.z;
 			RE::NiPoint3 direction{ cos(pitch) * sin(yaw), cos(pitch) * cos(yaw), -sin(pitch) };
-            if (direction.Unitize() <= std::numeric_limits<float>::epsilon()) {
-                return false;
-            }
+			if (direction.Unitize() <= std::numeric_limits<float>::epsilon()) {
+				return false;
+			}
+
+			snapshot.impacts.clear();
+			snapshot.cell = projectile.parentCell;
+			snapshot.cellID = snapshot.cell ? snapshot.cell->GetFormID() : 0;
+			snapshot.projectileBase = GetProjectileBase(projectile);
+			snapshot.shooter = projectile.shooter;
+			snapshot.weaponSource = projectile.weaponSource;
+			snapshot.ammo = projectile.ammoSource;
+			snapshot.equipIndex = projectile.equipIndex;
+			snapshot.spell = projectile.spell;
+			snapshot.spellID = snapshot.spell ? snapshot.spell->GetFormID() : 0;
+			snapshot.avEffect = projectile.avEffect;
+			snapshot.damage = projectile.damage;
+			snapshot.totalDamage = projectile.GetTotalDamage();
+			snapshot.actorCause = projectile.GetActorCause();
+			snapshot.power = projectile.power;
+			snapshot.direction = direction;
+
+			auto* shooter = Utils::ResolveActor(projectile.shooter);
+			auto* player = RE::PlayerCharacter::GetSingleton();
+			snapshot.pickFilter = Utils::ResolvePickFilter(shooter, snapshot.projectileBase);
+			snapshot.playerShot = player && shooter == player;
+			snapshot.playerDistanceSq = 0.0f;
+
+			const AmmoPenetration ammo = Penetration::GetAmmoPenetration(projectile.ammoSource);
+			snapshot.curve = ammo.curve;
+			for (auto& impact : projectile.impacts) {
+				if (impact.processed) {
+					continue;
+				}
+
+				const float materialMultiplier = Penetration::GetMaterialMultiplier(impact.materialType);
+				const float depthScale = ammo.multiplier * materialMultiplier;
+				const float penetrationDepth = CalculatePenetrationDepth(snapshot, depthScale, snapshot.power);
+				logger::debug(
+					FMT_STRING("[Penetration] Calculation depth {} (power {:.2f} damage {:.2f}, ammo {:.2f}{}, material {:.2f})"),
+					penetrationDepth,
+					snapshot.power,
+					snapshot.totalDamage,
+					ammo.multiplier,
+					ammo.curve ? " curve" : "",
+					materialMultiplier);
+				if (impact.materialType) {
+					logger::debug(
+						FMT_STRING("[Penetration] Impact Material: {}"),
+						impact.materialType->GetFormEditorID());
+				}
+
+				logger::debug(
+					FMT_STRING("[Penetration] Impact at ({:.2f}, {:.2f}, {:.2f})"),
+					impact.location.x,
+					impact.location.y,
+					impact.location.z);
+				ImpactSample sample{
+					.location = impact.location,
+					.normal = impact.normal,
+					.collidee = impact.collidee,
+					.body = reinterpret_cast<std::uintptr_t>(impact.colObj.get()),
+					.materialType = impact.materialType,
+					.along = direction.Dot(impact.location),
+					.depth = penetrationDepth,
+					.depthScale = depthScale,
+					.criticalCos = Penetration::GetCriticalAngleCosine(impact.materialType) };
+				if (const auto collidee = impact.collidee.get()) {
+					sample.collideeCell = collidee->parentCell;
+					if (const auto* root = collidee->Get3D()) {
+						sample.collideeRoot = root;
+						sample.collideeWorld = root->world;
+					}
+				}
+				snapshot.impacts.push_back(sample);
+			}
+
+			if (snapshot.impacts.empty() || !snapshot.cell) {
+				return false;
+			}
+
+			if (snapshot.ammo && snapshot.projectileBase) {
+				logger::debug("[Penetration] Ammo : {} (FormID {:08X}) - Projectile FormID {:08X} col {:.2f} scale {:.2f}",
+					snapshot.ammo->fullName.c_str(), snapshot.ammo->formID,
+					snapshot.projectileBase->formID, snapshot.projectileBase->data.collisionRadius, projectile.scale);
+			}
+
+			std::sort(snapshot.impacts.begin(), snapshot.impacts.end(), [](const ImpactSample& lhs, const ImpactSample& rhs) {
+				return lhs.along < rhs.along;
+			});
+
+			if (player) {
+				const RE::NiPoint3 offset = snapshot.impacts.front().location - player->data.location;
+				snapshot.playerDistanceSq = offset.Dot(offset);
+			}
+			return true;
+		}
 
-            auto* shooter = Utils::ResolveActor(projectile->shooter);
-
-            Utils::RaycastHit hit{};
-
-			constexpr float kSurfaceOffset = 0.5f;
-            RE::NiPoint3 start = impactData->location + direction * kSurfaceOffset;
-            RE::NiPoint3 end = impactData->location + direction * penetrationDepth;
-
-			RE::bhkPickData pickData;
-            auto selectExitHit = [&](std::string_view label) {
-				const auto hitCount = pickData.GetAllCollectorRayHitSize();
-				Utils::RaycastHit realHit = hit;
-				if (hitCount > 0 && Utils::SelectRealExit(pickData, impactData->location, realHit)) {
-					hit = realHit;
-                }
-
-                logger::info(
-                    FMT_STRING("[Penetration] {} ray hit count {} exit ({:.2f}, {:.2f}, {:.2f})"),
-                    label,
-                    hitCount,
-                    hit.point.x,
-                    hit.point.y,
-                    hit.point.z);
+		using Clock = std::chrono::steady_clock;
+
+		struct Outcome
+		{
+			Resolution resolution{ Resolution::kStopped };
+			Utils::RaycastHit exit{};
+			float power{ 0.0f };
+		};
+
+		using PenetrationTask = Task<Outcome>;
+
+		// Whether work queued at `queued` (wall clock) and `frame` (scheduler ticks) has outlived the
+		// latency tolerance. Deterministic mode counts ticks, at 60 per second of tolerance, so a
+		// replay drops the same work regardless of frame times.
+		bool IsLate(Clock::time_point queued, std::uint32_t frame, Clock::time_point now)
+		{
+			const auto& settings = GetSettings();
+			if (settings.deterministicWorkers) {
+				const std::uint32_t frames = std::max((settings.deferredLatencyMs * 60 + 999) / 1000, 1u);
+				return Scheduler::CurrentFrame() - frame > frames;
+			}
+			return now - queued > std::chrono::milliseconds(settings.deferredLatencyMs);
+		}
+
+		// Scheduling data for a pipeline waiting on raycast budget. Waiting pipelines are resumed
+		// on later ticks, player shots first and then by distance to the player, and dropped once
+		// they are older than the latency tolerance or pushed out by higher-priority work.
+		struct Deferral
+		{
+			RE::TESFormID cell{ 0 };
+			bool playerShot{ false };
+			float distanceSq{ 0.0f };
+			Clock::time_point queued{};
+			std::uint32_t frame{ 0 };
+
+			bool operator<(const Deferral& other) const noexcept
+			{
+				if (playerShot != other.playerShot) {
+					return playerShot;
+				}
+				return distanceSq < other.distanceSq;
+			}
+		};
+
+		struct SuspendedPenetration
+		{
+			std::coroutine_handle<> handle;
+			Deferral deferral;
+
+			bool operator<(const SuspendedPenetration& other) const noexcept { return deferral < other.deferral; }
+		};
+
+		struct ResumeQueue
+		{
+			Memory::Vector<Memory::Tag::kPendingWork, SuspendedPenetration> entries;
+			std::mutex lock;
+
+			std::atomic<std::uint64_t> suspended{ 0 };
+			std::atomic<std::uint64_t> resumed{ 0 };
+			std::atomic<std::uint64_t> dropped{ 0 };
+		};
+
+		ResumeQueue g_waiting;
+
+		Deferral MakeDeferral(const PenetrationSnapshot& snapshot)
+		{
+			return {
+				.cell = snapshot.cellID,
+				.playerShot = snapshot.playerShot,
+				.distanceSq = snapshot.playerDistanceSq,
+				.queued = Clock::now(),
+				.frame = Scheduler::CurrentFrame()
 			};
-			RE::NiPoint3 exitDirection = direction;
+		}
 
-			bool hitFound = Utils::PerformRaycast(*projectile, shooter, projectileBase, start, end, pickData, hit, true);
+		// The cell only while it is attached to a physics world; raycasts and launches need one.
+		RE::TESObjectCELL* ResolveLoadedCell(RE::TESFormID cellID)
+		{
+			auto* form = cellID ? RE::TESForm::GetFormByID(cellID) : nullptr;
+			auto* cell = form ? form->As<RE::TESObjectCELL>() : nullptr;
+			return cell && cell->GetbhkWorld() ? cell : nullptr;
+		}
 
-			if (hitFound) {
-				selectExitHit("Forward");
-			} else {
-				start = impactData->location + direction * penetrationDepth;
-				end = impactData->location + direction * kSurfaceOffset;
+		// Refreshes the form pointers of a deferred snapshot after a frame boundary. Returns false
+		// when the cell has unloaded or the spell no longer exists.
+		bool Reacquire(PenetrationSnapshot& snapshot)
+		{
+			using Spell = std::remove_pointer_t<decltype(snapshot.spell)>;
 
-				if (!Utils::PerformRaycast(*projectile, shooter, projectileBase, start, end, pickData, hit, true)) {
-					logger::info(FMT_STRING("[Penetration] Reverse ray also missed"));
+			snapshot.cell = ResolveLoadedCell(snapshot.cellID);
+			snapshot.spell = nullptr;
+			if (snapshot.spellID) {
+				auto* form = RE::TESForm::GetFormByID(snapshot.spellID);
+				snapshot.spell = form ? form->As<Spell>() : nullptr;
+				if (!snapshot.spell) {
 					return false;
 				}
-				selectExitHit("Reverse");
 			}
+			return snapshot.cell != nullptr;
+		}
 
-			pickData.Reset();
+		// Replaces the in-flight beam memo entry of a deferred or queued snapshot with its outcome.
+		void SettleBeamImpact(const PenetrationSnapshot& snapshot, bool penetrated)
+		{
+			if (snapshot.beamImpact.beam != 0) {
+				Cache::RememberBeamOutcome(snapshot.beamImpact, penetrated ? Cache::BeamOutcome::kPenetrated : Cache::BeamOutcome::kStopped);
+			}
+		}
 
-            const float travelled = impactData->location.GetDistance(hit.point);
-            if (travelled <= std::numeric_limits<float>::epsilon()) {
-                logger::info(FMT_STRING("[Penetration] Hit point too close to impact location"));
-                return false;
-			} else if (travelled > penetrationDepth) {
-				logger::info(FMT_STRING("[Penetration] Hit point farther than penetration depth?"));
+		// Takes ownership of a suspended frame. When the queue is full the lowest-priority frame,
+		// possibly the new one, is destroyed.
+		void Suspend(std::coroutine_handle<> handle, const Deferral& deferral)
+		{
+			SuspendedPenetration entry{ handle, deferral };
+			std::coroutine_handle<> evicted;
+			{
+				std::scoped_lock lock(g_waiting.lock);
+				if (g_waiting.entries.size() >= GetSettings().deferredQueueSize) {
+					auto worst = std::max_element(g_waiting.entries.begin(), g_waiting.entries.end());
+					if (worst == g_waiting.entries.end() || !(entry < *worst)) {
+						evicted = handle;
+					} else {
+						evicted = std::exchange(*worst, entry).handle;
+					}
+				} else {
+					g_waiting.entries.push_back(entry);
+				}
+			}
+
+			if (evicted) {
+				g_waiting.dropped.fetch_add(1, std::memory_order_relaxed);
+				evicted.destroy();
+			}
+			if (evicted != handle) {
+				g_waiting.suspended.fetch_add(1, std::memory_order_relaxed);
+				Scheduler::RequestTick();
+			}
+		}
+
+		// Suspends a pipeline until a later tick has raycast budget for it.
+		struct NextTick
+		{
+			const Deferral& deferral;
+
+			bool await_ready() const noexcept { return false; }
+
+			template <class Promise>
+			void await_suspend(std::coroutine_handle<Promise> handle) const
+			{
+				handle.promise().Release();
+				Suspend(handle, deferral);
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+		void ResumeWaiting()
+		{
+			Memory::Vector<Memory::Tag::kPendingWork, SuspendedPenetration> waiting;
+			{
+				std::scoped_lock lock(g_waiting.lock);
+				waiting.swap(g_waiting.entries);
+			}
+			if (waiting.empty()) {
+				return;
+			}
+
+			std::sort(waiting.begin(), waiting.end());
+
+			const auto now = Clock::now();
+			Memory::Vector<Memory::Tag::kPendingWork, SuspendedPenetration> remaining;
+			for (auto& entry : waiting) {
+				if (IsLate(entry.deferral.queued, entry.deferral.frame, now) || !ResolveLoadedCell(entry.deferral.cell)) {
+					g_waiting.dropped.fetch_add(1, std::memory_order_relaxed);
+					entry.handle.destroy();
+					continue;
+				}
+
+				if (!Scheduler::HasBudget()) {
+					remaining.push_back(entry);
+					continue;
+				}
+
+				// Runs to completion or to its next suspension, which re-queues it.
+				g_waiting.resumed.fetch_add(1, std::memory_order_relaxed);
+				entry.handle.resume();
+			}
+
+			if (remaining.empty()) {
+				return;
+			}
+
+			{
+				std::scoped_lock lock(g_waiting.lock);
+				g_waiting.entries.insert(g_waiting.entries.end(), remaining.begin(), remaining.end());
+			}
+			Scheduler::RequestTick();
+		}
+
+		void ClearWaiting()
+		{
+			Memory::Vector<Memory::Tag::kPendingWork, SuspendedPenetration> waiting;
+			{
+				std::scoped_lock lock(g_waiting.lock);
+				waiting.swap(g_waiting.entries);
+			}
+			for (auto& entry : waiting) {
+				entry.handle.destroy();
+			}
+		}
+
+		// The penetration pipeline: lookup, cast and select for every impact in the snapshot, then
+		// spawn. Impacts are walked in path order as a chain: each one has to be crossed for the
+		// shot to reach the next, power carries over between them, and a single exit is produced for
+		// the last one. If the first impact stops the shot, the game resolves the impacts as usual;
+		// if a later one does, the chain ends there and the shot continues from the last exit that
+		// was crossed, so the spawned projectile meets the stopping surface through the normal
+		// impact path.
+		//
+		// When a cast is over the frame budget the pipeline suspends and resumes on a later tick at
+		// the same impact. Each link's depth is re-derived at the power carried into it, so a thick
+		// first layer leaves a shallower depth for the next; the batch reach is sized from the
+		// depths at the initial power. The snapshot is borrowed from the caller until the first suspension and
+		// copied into the frame then. A pipeline that suspended spawns its own result and settles its
+		// beam memo entry; otherwise the outcome is returned to the caller, which does both.
+		PenetrationTask RunPenetration(const PenetrationSnapshot& source, SpawnFn spawn)
+		{
+			// Hit lists from the previous resolution on this thread are dead by now. Scratch memory
+			// is never held across a suspension: the batch is rebuilt after every resume.
+			Utils::ResetScratch();
+
+			const PenetrationSnapshot* snapshot = std::addressof(source);
+			std::optional<PenetrationSnapshot> owned;
+			std::optional<Deferral> deferral;
+			const auto takeOwnership = [&]() {
+				if (!owned) {
+					owned.emplace(source);
+					owned->actorCause = nullptr;
+					snapshot = std::addressof(*owned);
+					deferral.emplace(MakeDeferral(*snapshot));
+				}
+				owned->cell = nullptr;
+				owned->spell = nullptr;
+			};
+			const auto settle = [&](bool penetrated) {
+				if (owned) {
+					SettleBeamImpact(*owned, penetrated);
+				}
+			};
+
+			float reach = std::numeric_limits<float>::lowest();
+			for (const auto& entry : snapshot->impacts) {
+				reach = std::max(reach, entry.along + entry.depth);
+			}
+
+			std::optional<PenetrationContext> context;
+			context.emplace(*snapshot);
+			std::optional<ExitBatch> batch;
+			batch.emplace();
+
+			Outcome outcome;
+			Utils::RaycastHit exit{};
+			float exitAlong = 0.0f;
+			float power = snapshot->power;
+			const ImpactSample* last = nullptr;
+			float lastDepth = 0.0f;
+			float lastRemaining = 0.0f;
+			bool lastReused = false;
+			bool chainStopped = false;
+
+			for (std::size_t index = 0; index < snapshot->impacts.size();) {
+				const ImpactSample& sample = snapshot->impacts[index];
+				if (last && sample.along <= exitAlong) {
+					++index;
+					continue;
+				}
+
+				const float linkPower = last ? power * std::clamp(lastRemaining / lastDepth, 0.0f, 1.0f) : power;
+				ImpactSample entry = sample;
+				entry.depth = CalculatePenetrationDepth(*snapshot, sample.depthScale, linkPower);
+
+				if (entry.depth <= 0.0f || IsGrazingImpact(entry, snapshot->direction)) {
+					chainStopped = true;
+					break;
+				}
+
+				bool reused = false;
+				const Resolution resolution = ResolveExit(*context, entry, reach, *batch, exit, reused);
+				if (resolution == Resolution::kStopped) {
+					chainStopped = true;
+					break;
+				}
+				if (resolution == Resolution::kOverBudget) {
+					const std::size_t lastIndex = last ? static_cast<std::size_t>(last - snapshot->impacts.data()) : 0;
+					takeOwnership();
+					co_await NextTick{ *deferral };
+					if (!Reacquire(*owned)) {
+						settle(false);
+						co_return outcome;
+					}
+
+					last = last ? std::addressof(snapshot->impacts[lastIndex]) : nullptr;
+					context.emplace(*snapshot);
+					batch.reset();
+					batch.emplace();
+					continue;
+				}
+
+				const float travelled = entry.location.GetDistance(exit.point);
+				if (travelled <= std::numeric_limits<float>::epsilon()) {
+					logger::debug(FMT_STRING("[Penetration] Hit point too close to impact location"));
+					chainStopped = true;
+					break;
+				} else if (travelled > entry.depth) {
+					logger::debug(FMT_STRING("[Penetration] Hit point farther than penetration depth?"));
+					chainStopped = true;
+					break;
+				}
+
+				power = linkPower;
+				last = std::addressof(sample);
+				lastDepth = entry.depth;
+				lastRemaining = entry.depth - travelled;
+				lastReused = reused;
+				outcome.exit = exit;
+				exitAlong = snapshot->direction.Dot(exit.point);
+				++index;
+			}
+
+			if (!last) {
+				settle(false);
+				co_return outcome;
+			}
+
+			// An exit reused from a cache was resolved without a Havok query; walking further layers
+			// would issue one anyway, so reused exits stop at the first layer. A chain cut short by a
+			// later impact stops in front of it. Otherwise further layers are worth a frame of delay
+			// rather than being skipped.
+			const bool walkLayers = !chainStopped && !lastReused && GetSettings().maxLayers > 1 && lastRemaining > kMinLayerThickness;
+			if (walkLayers && !Scheduler::HasBudget()) {
+				const std::size_t lastIndex = static_cast<std::size_t>(last - snapshot->impacts.data());
+				takeOwnership();
+				co_await NextTick{ *deferral };
+				if (!Reacquire(*owned)) {
+					settle(false);
+					co_return outcome;
+				}
+
+				last = std::addressof(snapshot->impacts[lastIndex]);
+				context.emplace(*snapshot);
+			}
+
+			const float remainingDepth = walkLayers ? WalkAdditionalLayers(*context, lastRemaining, outcome.exit) : lastRemaining;
+			outcome.power = power * std::clamp(remainingDepth / lastDepth, 0.0f, 1.0f);
+			if (outcome.power <= std::numeric_limits<float>::epsilon()) {
+				logger::debug(
+					FMT_STRING("[Penetration] No power left after travelling {:.2f}/{:.2f} (power {:.2f})"),
+					lastDepth - remainingDepth,
+					lastDepth,
+					snapshot->power);
+				settle(false);
+				co_return outcome;
+			}
+
+			outcome.resolution = Resolution::kPenetrated;
+			if (owned) {
+				settle(spawn(*snapshot, outcome.exit, snapshot->direction, outcome.power));
+			}
+			co_return outcome;
+		}
+
+		// Async jobs are queued by the hooks and dispatched by the next scheduler tick. The tick
+		// re-resolves each job's cell and spell, hands the jobs to the worker pool and waits for all
+		// of them before it returns. The game thread is parked inside the tick for the whole
+		// dispatch, so no cell detaches, no form is freed and no setting is rewritten while a worker
+		// casts: workers query the same world state a synchronous cast from the hook would. A job
+		// older than the latency tolerance is dropped (the game's own impact stands), and outcomes
+		// are spawned on the game thread in submission order. A pipeline that runs out of budget on
+		// a worker suspends like a synchronous one and spawns from its own copy on a later tick.
+		struct AsyncJob
+		{
+			PenetrationSnapshot snapshot;
+			SpawnFn spawn{ nullptr };
+			Clock::time_point queued{};
+			std::uint32_t frame{ 0 };
+			Outcome outcome{};
+			bool settled{ false };
+		};
+
+		struct AsyncQueue
+		{
+			Memory::Vector<Memory::Tag::kPendingWork, AsyncJob> jobs;
+			std::mutex lock;
+
+			std::atomic<std::uint64_t> submitted{ 0 };
+			std::atomic<std::uint64_t> applied{ 0 };
+			std::atomic<std::uint64_t> late{ 0 };
+		};
+
+		AsyncQueue g_async;
+
+		// Queues the snapshot for the next tick. Returns false when async resolution is disabled,
+		// in which case the caller resolves synchronously. Safe from any thread that runs the hooks.
+		bool ResolveAsync(const PenetrationSnapshot& snapshot, SpawnFn spawn)
+		{
+			if (!GetSettings().asyncResolution) {
 				return false;
 			}
 
-            const float depthDenominator = penetrationDepth > std::numeric_limits<float>::epsilon() ? penetrationDepth : travelled;
-            const float travelRatio = depthDenominator > std::numeric_limits<float>::epsilon() ? travelled / depthDenominator : 1.0f;
-            const float remainingPower = projectile->power * std::clamp(1.0f - travelRatio, 0.0f, 1.0f);
-            if (remainingPower <= std::numeric_limits<float>::epsilon()) {
-                logger::info(
-                    FMT_STRING("[Penetration] No power left after travelling {:.2f}/{:.2f} (power {:.2f})"),
-                    travelled,
-                    depthDenominator,
-                    projectile->power);
-                return false;
-            }
+			{
+				std::scoped_lock lock(g_async.lock);
+				auto& job = g_async.jobs.emplace_back(AsyncJob{ snapshot, spawn, Clock::now(), Scheduler::CurrentFrame() });
+				// The source projectile may be gone by the tick.
+				job.snapshot.actorCause = nullptr;
+			}
+			g_async.submitted.fetch_add(1, std::memory_order_relaxed);
+			Scheduler::RequestTick();
+			return true;
+		}
 
-            if (!SpawnPenetratedProjectile(*projectile, hit, exitDirection, remainingPower)) {
-                logger::info(FMT_STRING("[Penetration] Failed to spawn penetrated projectile"));
-                return false;
-            }
-            return true;
-        }
+		void RunAsyncJob(AsyncJob& job)
+		{
+			auto task = RunPenetration(job.snapshot, job.spawn);
+			if (task.Start()) {
+				job.outcome = task.Result();
+				job.settled = true;
+			}
+		}
 
-        bool ProjectileProcessImpactsHook(RE::Projectile* projectile)
+		// Game thread only: blocks until every dispatched job has finished.
+		void DispatchAsyncJobs()
 		{
-			ApplyPendingShooter(projectile);
-			TryHandlePenetration(projectile);
-			auto fn = reinterpret_cast<ProjectileProcessFn>(g_projectileProcessImpactsOriginal);
-			return fn ? fn(projectile) : false;
-        }
+			Memory::Vector<Memory::Tag::kPendingWork, AsyncJob> jobs;
+			{
+				std::scoped_lock lock(g_async.lock);
+				jobs.swap(g_async.jobs);
+			}
 
-        bool MissileProcessImpactsHook(RE::MissileProjectile* projectile)
+			const auto now = Clock::now();
+			std::erase_if(jobs, [&](AsyncJob& job) {
+				if (!IsLate(job.queued, job.frame, now) && Reacquire(job.snapshot)) {
+					return false;
+				}
+				g_async.late.fetch_add(1, std::memory_order_relaxed);
+				SettleBeamImpact(job.snapshot, false);
+				return true;
+			});
+			if (jobs.empty()) {
+				return;
+			}
+
+			std::latch done(static_cast<std::ptrdiff_t>(jobs.size()));
+			for (auto& job : jobs) {
+				const auto run = [&job, &done]() {
+					RunAsyncJob(job);
+					done.count_down();
+				};
+				if (!Workers::Submit(run)) {
+					run();
+				}
+			}
+			done.wait();
+
+			for (auto& job : jobs) {
+				if (!job.settled) {
+					continue;
+				}
+				const auto& outcome = job.outcome;
+				const bool penetrated = outcome.resolution == Resolution::kPenetrated &&
+				                        job.spawn(job.snapshot, outcome.exit, job.snapshot.direction, outcome.power);
+				if (penetrated) {
+					g_async.applied.fetch_add(1, std::memory_order_relaxed);
+				}
+				SettleBeamImpact(job.snapshot, penetrated);
+			}
+		}
+
+		void ClearAsyncJobs()
 		{
-			ApplyPendingShooter(projectile);
-            TryHandlePenetration(projectile);
-            auto fn = reinterpret_cast<MissileProcessFn>(g_missileProcessImpactsOriginal);
-            return fn ? fn(projectile) : false;
-        }
+			std::scoped_lock lock(g_async.lock);
+			g_async.jobs.clear();
+		}
 
-        bool BeamProcessImpactsHook(RE::BeamProjectile* projectile)
+		void RunFrameWork()
 		{
-			ApplyPendingShooter(projectile);
-            TryHandlePenetration(projectile);
-            auto fn = reinterpret_cast<BeamProcessFn>(g_beamProcessImpactsOriginal);
-            return fn ? fn(projectile) : false;
-        }
+			DispatchAsyncJobs();
+			ResumeWaiting();
+
+			// Keeps ticking while shooter assignments are pending so they expire even after
+			// penetrations stop; otherwise the table would keep the ProcessImpacts fast path off.
+			PendingShooters::Expire();
+			if (GetSettings().pendingShooterLifetimeMs != 0 && !PendingShooters::Empty()) {
+				Scheduler::RequestTick();
+			}
+		}
+
+		enum class Handling
+		{
+			kNotPenetrated,
+			kPenetrated,
+			kPending
+		};
+
+		// kPending means the shot was queued for the next tick or suspended until a later one and its
+		// outcome is not known yet; it is applied by spawning once resolved.
+		template <class T>
+		Handling TryHandlePenetration(T* projectile, const BeamImpactKey& beamImpact = {})
+		{
+			if (!projectile) {
+				return Handling::kNotPenetrated;
+			}
+
+			if (projectile->explosion) {
+				return Handling::kNotPenetrated;
+			}
+
+			// Reused per thread so the impact list keeps its capacity; deferral and async paths copy it.
+			thread_local PenetrationSnapshot snapshot;
+			if (!CaptureSnapshot(*projectile, snapshot)) {
+				return Handling::kNotPenetrated;
+			}
+			snapshot.beamImpact = beamImpact;
+
+			if (ResolveAsync(snapshot, &SpawnPenetratedProjectile<T>)) {
+				return Handling::kPending;
+			}
+
+			auto task = RunPenetration(snapshot, &SpawnPenetratedProjectile<T>);
+			if (!task.Start()) {
+				logger::debug(FMT_STRING("[Penetration] Raycast budget spent; resuming impact next frame"));
+				return Handling::kPending;
+			}
+
+			const auto& [resolution, hit, remainingPower] = task.Result();
+			if (resolution != Resolution::kPenetrated) {
+				return Handling::kNotPenetrated;
+			}
+
+			if (!SpawnPenetratedProjectile<T>(snapshot, hit, snapshot.direction, remainingPower)) {
+				logger::debug(FMT_STRING("[Penetration] Failed to spawn penetrated projectile"));
+				return Handling::kNotPenetrated;
+			}
+			return Handling::kPenetrated;
+		}
+
+		// The impact is marked in flight before it is evaluated, so repeats of it are suppressed
+		// until the outcome is known. A settled outcome overwrites the mark right away; a pending
+		// one is settled by its pipeline or by the async dispatch once resolved or dropped.
+		template <class T>
+		bool HandleImpacts(T* projectile)
+		{
+			if constexpr (ProjectileTraits<T>::kMemoizesImpacts) {
+				const RE::Projectile::ImpactData* first = nullptr;
+				for (const auto& impact : projectile->impacts) {
+					if (!impact.processed) {
+						first = std::addressof(impact);
+						break;
+					}
+				}
+				if (!first) {
+					return false;
+				}
+
+				const BeamImpactKey key = Cache::MakeBeamImpactKey(RE::ProjectileHandle{ projectile }, *first);
+				Cache::BeamOutcome recalled{};
+				if (Cache::RecallBeamOutcome(key, recalled)) {
+					return recalled != Cache::BeamOutcome::kStopped;
+				}
+
+				Cache::RememberBeamOutcome(key, Cache::BeamOutcome::kInFlight);
+				const Handling handling = TryHandlePenetration(projectile, key);
+				if (handling != Handling::kPending) {
+					Cache::RememberBeamOutcome(key, handling == Handling::kPenetrated ? Cache::BeamOutcome::kPenetrated : Cache::BeamOutcome::kStopped);
+				}
+				return handling != Handling::kNotPenetrated;
+			} else {
+				return TryHandlePenetration(projectile) != Handling::kNotPenetrated;
+			}
+		}
+
+		bool HasUnprocessedImpact(const RE::Projectile& projectile)
+		{
+			for (const auto& impact : projectile.impacts) {
+				if (!impact.processed) {
+					return true;
+				}
+			}
+			return false;
+		}
+
+		// Cheap gate for the hooks: most projectiles have nothing new to resolve on a given frame,
+		// ineligible ammo can never penetrate, and a shot without power or damage has no depth.
+		bool ShouldEvaluate(RE::Projectile* projectile)
+		{
+			return projectile &&
+			       HasUnprocessedImpact(*projectile) &&
+			       Penetration::IsPenetrationCandidate(projectile->ammoSource) &&
+			       projectile->power > 0.0f &&
+			       projectile->GetTotalDamage() > 0.0f;
+		}
+
+		template <class T>
+		struct ProcessImpactsHook
+		{
+			static bool thunk(T* projectile)
+			{
+				ApplyPendingShooter(projectile);
+				if constexpr (ProjectileTraits<T>::kPenetrates) {
+					if (ShouldEvaluate(projectile)) {
+						HandleImpacts(projectile);
+					}
+				}
+				auto fn = reinterpret_cast<decltype(&thunk)>(original);
+				return fn ? fn(projectile) : false;
+			}
+
+			static inline std::uintptr_t original = 0;
+		};
+
+		template <class T>
+		void InstallProcessImpactsHook()
+		{
+			REL::Relocation<std::uintptr_t> vtbl{ T::VTABLE[0] };
+			ProcessImpactsHook<T>::original = vtbl.write_vfunc(0xD0, ProcessImpactsHook<T>::thunk);
+		}
     }
 
     void Initialize()
     {
-        REL::Relocation<std::uintptr_t> projectileVtbl{ RE::Projectile::VTABLE[0] };
-        g_projectileProcessImpactsOriginal = projectileVtbl.write_vfunc(0xD0, ProjectileProcessImpactsHook);
-
-        REL::Relocation<std::uintptr_t> missileVtbl{ RE::MissileProjectile::VTABLE[0] };
-        g_missileProcessImpactsOriginal = missileVtbl.write_vfunc(0xD0, MissileProcessImpactsHook);
+		Scheduler::SetTickCallback(RunFrameWork);
 
-        REL::Relocation<std::uintptr_t> beamVtbl{ RE::BeamProjectile::VTABLE[0] };
-        g_beamProcessImpactsOriginal = beamVtbl.write_vfunc(0xD0, BeamProcessImpactsHook);
+		InstallProcessImpactsHook<RE::Projectile>();
+		InstallProcessImpactsHook<RE::MissileProjectile>();
+		InstallProcessImpactsHook<RE::BeamProjectile>();
 	}
 
 	void ClearPendingQueue()
 	{
-		std::scoped_lock lock(g_pendingShootersMutex);
-		g_pendingShooters.clear();
+		PendingShooters::LogStats();
+		PendingShooters::Clear();
+	}
+
+	void ResetCaches()
+	{
+		// Restarts the pool when the worker settings changed. Jobs only run while a tick waits for
+		// them, so none is in flight here.
+		const auto& settings = GetSettings();
+		if (settings.asyncResolution) {
+			Workers::Start(settings.asyncWorkers, settings.deterministicWorkers);
+		} else {
+			Workers::Stop();
+		}
+
+		Utils::InvalidateCollisionFilterCache();
+		Cache::LogStats();
+		Cache::Clear();
+
+		Scheduler::LogStats();
+		logger::info(
+			FMT_STRING("[Penetration] Suspended impacts: {} suspended, {} resumes, {} dropped"),
+			g_waiting.suspended.load(std::memory_order_relaxed),
+			g_waiting.resumed.load(std::memory_order_relaxed),
+			g_waiting.dropped.load(std::memory_order_relaxed));
+		ClearWaiting();
+		FramePool::LogStats();
+		Memory::LogStats();
+
+		Workers::LogStats();
+		logger::info(
+			FMT_STRING("[Penetration] Async impacts: {} queued, {} applied, {} late"),
+			g_async.submitted.load(std::memory_order_relaxed),
+			g_async.applied.load(std::memory_order_relaxed),
+			g_async.late.load(std::memory_order_relaxed));
+		ClearAsyncJobs();
 	}
 }
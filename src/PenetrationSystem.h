@@ -4,4 +4,5 @@ namespace Penetration
 {
 	void Initialize();
 	void ClearPendingQueue();
+	void ResetCaches();
 }
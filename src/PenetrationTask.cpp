@@ -0,0 +1,112 @@
+#include "PenetrationTask.h"
+
+#include "MemoryTracking.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <new>
+
+namespace Penetration::FramePool
+{
+	namespace
+	{
+		constexpr std::size_t kBlockSize = 2048;
+		constexpr std::size_t kBlocksPerChunk = 32;
+		constexpr std::size_t kMaxChunks = 16;
+
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		struct Pool
+		{
+			FreeBlock* free{ nullptr };
+			Memory::Vector<Memory::Tag::kCoroutines, std::unique_ptr<std::byte[]>> chunks;
+			std::mutex lock;
+
+			std::atomic<std::uint32_t> live{ 0 };
+			std::atomic<std::uint32_t> peak{ 0 };
+			std::atomic<std::uint64_t> overflow{ 0 };
+		};
+
+		Pool g_pool;
+
+		// Must be called with the lock held.
+		bool Grow()
+		{
+			if (g_pool.chunks.size() >= kMaxChunks) {
+				return false;
+			}
+
+			auto chunk = std::make_unique<std::byte[]>(kBlockSize * kBlocksPerChunk);
+			Memory::RecordAllocation(Memory::Tag::kCoroutines, kBlockSize * kBlocksPerChunk);
+			for (std::size_t i = 0; i < kBlocksPerChunk; ++i) {
+				auto* block = reinterpret_cast<FreeBlock*>(chunk.get() + i * kBlockSize);
+				block->next = g_pool.free;
+				g_pool.free = block;
+			}
+			g_pool.chunks.push_back(std::move(chunk));
+			return true;
+		}
+
+		bool Owns(const void* frame) noexcept
+		{
+			const auto* bytes = static_cast<const std::byte*>(frame);
+			for (const auto& chunk : g_pool.chunks) {
+				if (bytes >= chunk.get() && bytes < chunk.get() + kBlockSize * kBlocksPerChunk) {
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+
+	void* Allocate(std::size_t size)
+	{
+		if (size <= kBlockSize) {
+			std::scoped_lock lock(g_pool.lock);
+			if (g_pool.free || Grow()) {
+				auto* block = g_pool.free;
+				g_pool.free = block->next;
+
+				const std::uint32_t live = g_pool.live.fetch_add(1, std::memory_order_relaxed) + 1;
+				if (live > g_pool.peak.load(std::memory_order_relaxed)) {
+					g_pool.peak.store(live, std::memory_order_relaxed);
+				}
+				return block;
+			}
+		}
+
+		g_pool.overflow.fetch_add(1, std::memory_order_relaxed);
+		Memory::RecordAllocation(Memory::Tag::kCoroutines, size);
+		return ::operator new(size);
+	}
+
+	void Deallocate(void* frame, std::size_t size) noexcept
+	{
+		if (size <= kBlockSize) {
+			std::scoped_lock lock(g_pool.lock);
+			if (Owns(frame)) {
+				auto* block = static_cast<FreeBlock*>(frame);
+				block->next = g_pool.free;
+				g_pool.free = block;
+				g_pool.live.fetch_sub(1, std::memory_order_relaxed);
+				return;
+			}
+		}
+
+		Memory::RecordDeallocation(Memory::Tag::kCoroutines, size);
+		::operator delete(frame, size);
+	}
+
+	void LogStats()
+	{
+		logger::info(
+			FMT_STRING("[Penetration] Coroutine frames: {} live, peak {}, {} from the heap"),
+			g_pool.live.load(std::memory_order_relaxed),
+			g_pool.peak.load(std::memory_order_relaxed),
+			g_pool.overflow.load(std::memory_order_relaxed));
+	}
+}
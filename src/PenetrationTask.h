@@ -0,0 +1,98 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <utility>
+
+namespace Penetration
+{
+	// Block pool for coroutine frames. Frames up to the block size are recycled through a free
+	// list; larger frames, or any frame once the pool is at its cap, go to the global heap.
+	namespace FramePool
+	{
+		void* Allocate(std::size_t size);
+		void Deallocate(void* frame, std::size_t size) noexcept;
+		void LogStats();
+	}
+
+	// Lazily started coroutine returning a T. The owner calls Start(), which runs the
+	// body until it finishes or first suspends. A suspending awaiter must call Release() on the
+	// promise: the frame then belongs to whatever it suspended on and frees itself on completion.
+	template <class T>
+	class Task
+	{
+	public:
+		struct promise_type
+		{
+			struct FinalAwaiter
+			{
+				bool await_ready() const noexcept { return false; }
+				bool await_suspend(std::coroutine_handle<promise_type> handle) const noexcept { return !handle.promise().released; }
+				void await_resume() const noexcept {}
+			};
+
+			T value{};
+			bool released{ false };
+			bool* handedOff{ nullptr };
+
+			static void* operator new(std::size_t size) { return FramePool::Allocate(size); }
+			static void operator delete(void* frame, std::size_t size) noexcept { FramePool::Deallocate(frame, size); }
+
+			Task get_return_object() noexcept { return Task{ std::coroutine_handle<promise_type>::from_promise(*this) }; }
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+			void return_value(T result) { value = std::move(result); }
+			void unhandled_exception() const noexcept { std::terminate(); }
+
+			void Release() noexcept
+			{
+				released = true;
+				if (handedOff) {
+					*handedOff = true;
+					handedOff = nullptr;
+				}
+			}
+		};
+
+		Task(Task&& other) noexcept :
+			handle(std::exchange(other.handle, nullptr))
+		{}
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+		Task& operator=(Task&&) = delete;
+
+		~Task()
+		{
+			if (handle) {
+				handle.destroy();
+			}
+		}
+
+		// Returns true when the body ran to completion; Result() is then valid. Returns false when
+		// it suspended, after which this Task no longer refers to the frame.
+		bool Start()
+		{
+			bool handedOff = false;
+			handle.promise().handedOff = std::addressof(handedOff);
+			handle.resume();
+			if (handedOff) {
+				handle = nullptr;
+				return false;
+			}
+			handle.promise().handedOff = nullptr;
+			return true;
+		}
+
+		const T& Result() const noexcept { return handle.promise().value; }
+
+	private:
+		explicit Task(std::coroutine_handle<promise_type> coroutine) noexcept :
+			handle(coroutine)
+		{}
+
+		std::coroutine_handle<promise_type> handle;
+	};
+}
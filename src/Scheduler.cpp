@@ -0,0 +1,136 @@
+#include "Scheduler.h"
+
+#include "PenetrationConfig.h"
+
+#include <atomic>
+
+namespace Penetration::Scheduler
+{
+	namespace
+	{
+		// A budget frame runs from one tick to the next. Ticks are F4SE tasks, which execute on the
+		// game thread once per frame. F4SE drains its task queue until empty, so a tick requested
+		// while a tick is running is recorded and re-queued when the tick ends through the UI task
+		// queue, which is drained at a different point of the frame. That UI task adds the next
+		// tick, so the budget is reset at most once per game frame while still being driven
+		// without any projectile hook firing.
+		std::atomic<std::uint32_t> g_used{ 0 };
+		std::atomic<std::uint32_t> g_frame{ 0 };
+		std::atomic<bool> g_tickScheduled{ false };
+		std::atomic<bool> g_tickWanted{ false };
+		std::atomic<bool> g_inTick{ false };
+		std::atomic<TickCallback> g_callback{ nullptr };
+
+		std::atomic<std::uint32_t> g_peakUsed{ 0 };
+		std::atomic<std::uint64_t> g_exhaustedFrames{ 0 };
+
+		void ScheduleTick() noexcept;
+
+		// Queues a tick for the next frame from a context where adding it directly could run it in
+		// the task drain that is already in progress.
+		void ScheduleNextFrame() noexcept
+		{
+			const auto* tasks = F4SE::GetTaskInterface();
+			if (!tasks) {
+				return;
+			}
+
+			tasks->AddUITask([]() { ScheduleTick(); });
+		}
+
+		void RunTick()
+		{
+			g_tickScheduled.store(false, std::memory_order_release);
+			g_inTick.store(true, std::memory_order_release);
+
+			const std::uint32_t used = g_used.exchange(0, std::memory_order_acq_rel);
+			if (used > g_peakUsed.load(std::memory_order_relaxed)) {
+				g_peakUsed.store(used, std::memory_order_relaxed);
+			}
+			const std::uint32_t budget = GetSettings().raycastBudget;
+			if (budget != 0 && used >= budget) {
+				g_exhaustedFrames.fetch_add(1, std::memory_order_relaxed);
+			}
+			g_frame.fetch_add(1, std::memory_order_relaxed);
+
+			if (auto callback = g_callback.load(std::memory_order_acquire)) {
+				callback();
+			}
+
+			g_inTick.store(false);
+			if (g_tickWanted.exchange(false)) {
+				ScheduleNextFrame();
+			}
+		}
+
+		void ScheduleTick() noexcept
+		{
+			if (g_tickScheduled.exchange(true, std::memory_order_acq_rel)) {
+				return;
+			}
+
+			const auto* tasks = F4SE::GetTaskInterface();
+			if (!tasks) {
+				g_tickScheduled.store(false, std::memory_order_release);
+				g_used.store(0, std::memory_order_relaxed);
+				return;
+			}
+
+			tasks->AddTask([]() { RunTick(); });
+		}
+	}
+
+	void SetTickCallback(TickCallback callback) noexcept
+	{
+		g_callback.store(callback, std::memory_order_release);
+	}
+
+	// Deterministic mode never defers on budget: how many casts fit in a frame depends on timing,
+	// so a replay would defer different impacts. Casts are still counted for the stats.
+	bool HasBudget() noexcept
+	{
+		const auto& settings = GetSettings();
+		const std::uint32_t budget = settings.raycastBudget;
+		return budget == 0 || settings.deterministicWorkers || g_used.load(std::memory_order_relaxed) < budget;
+	}
+
+	void ChargeRaycast() noexcept
+	{
+		if (GetSettings().raycastBudget == 0) {
+			return;
+		}
+
+		g_used.fetch_add(1, std::memory_order_relaxed);
+		RequestTick();
+	}
+
+	// Requests from worker threads can race with the end of a tick. The flag is stored before
+	// g_inTick is re-read and RunTick clears g_inTick before taking the flag (both sequentially
+	// consistent), so either the tick sees the request or the requester does and queues it.
+	void RequestTick() noexcept
+	{
+		if (g_inTick.load()) {
+			g_tickWanted.store(true);
+			if (g_inTick.load() || !g_tickWanted.exchange(false)) {
+				return;
+			}
+			ScheduleNextFrame();
+			return;
+		}
+
+		ScheduleTick();
+	}
+
+	std::uint32_t CurrentFrame() noexcept
+	{
+		return g_frame.load(std::memory_order_relaxed);
+	}
+
+	void LogStats()
+	{
+		logger::info(
+			FMT_STRING("[Penetration] Raycast budget: peak {} per frame, {} frames exhausted"),
+			g_peakUsed.load(std::memory_order_relaxed),
+			g_exhaustedFrames.load(std::memory_order_relaxed));
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Penetration::Scheduler
+{
+	using TickCallback = void (*)();
+
+	void SetTickCallback(TickCallback callback) noexcept;
+
+	bool HasBudget() noexcept;
+	void ChargeRaycast() noexcept;
+
+	void RequestTick() noexcept;
+	// Number of ticks run so far; at most one per game frame.
+	std::uint32_t CurrentFrame() noexcept;
+
+	void LogStats();
+}
@@ -1,8 +1,20 @@
 #include "Utils.h"
 
+#include "MemoryTracking.h"
+
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
 #include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <system_error>
+#include <unordered_map>
 
 #include <REL/Relocation.h>
 
@@ -21,7 +33,16 @@ namespace
 	REL::Relocation<std::uint64_t*> g_collisionFilterRoot{ REL::ID(469495) };
 	REL::Relocation<float*> g_ptrBS2HkScale{ REL::ID(1126486) };
 
-	void ConfigurePickFilter(RE::bhkPickData& pickData, RE::Actor* shooter, RE::BGSProjectile* projectileBase, bool excludeShooter)
+	struct CollisionFilterCache
+	{
+		Penetration::Memory::UnorderedMap<Penetration::Memory::Tag::kCaches, const RE::BGSProjectile*, std::uint64_t> filters;
+		std::shared_mutex lock;
+		std::atomic<std::uint32_t> generation{ 1 };
+	};
+
+	CollisionFilterCache g_collisionFilterCache;
+
+	bool ComputeCollisionFilter(const RE::BGSProjectile* projectileBase, std::uint64_t& outFilter)
 	{
 		std::uint32_t collisionIndex = 6;
 		std::uint64_t flagMask = 0x15C15160;
@@ -39,46 +60,187 @@ namespace
 		if (g_collisionFilterRoot.address() != 0) {
 			filterRoot = *g_collisionFilterRoot;
 		}
-		if (filterRoot) {
-			auto* filterEntry = reinterpret_cast<std::uint64_t*>(filterRoot + 0x1A0 + (0x8 * collisionIndex));
-			const std::uint64_t collisionFilter = (*filterEntry | 0x40000000ull) & ~flagMask;
-			*reinterpret_cast<std::uint64_t*>(reinterpret_cast<std::uintptr_t>(&pickData) + 0xC8) = collisionFilter;
+		if (!filterRoot) {
+			return false;
 		}
 
-		std::uint32_t collisionGroup = 6;
-		if (excludeShooter && shooter && shooter->loadedData) {
-			auto* loadedFlag = reinterpret_cast<std::uint8_t*>(shooter->loadedData) + 0x20;
-			if ((*loadedFlag & 0x1) != 0) {
-				collisionGroup = shooter->GetCurrentCollisionGroup();
+		auto* filterEntry = reinterpret_cast<std::uint64_t*>(filterRoot + 0x1A0 + (0x8 * collisionIndex));
+		outFilter = (*filterEntry | 0x40000000ull) & ~flagMask;
+		return true;
+	}
+
+	// The filter only depends on the projectile base, so the per-ray cost is a thread-local
+	// compare in the common case and a shared lookup otherwise. Entries are dropped whenever
+	// the generation is bumped by InvalidateCollisionFilterCache.
+	bool GetCollisionFilter(const RE::BGSProjectile* projectileBase, std::uint64_t& outFilter)
+	{
+		struct LastFilter
+		{
+			const RE::BGSProjectile* base{ nullptr };
+			std::uint64_t filter{ 0 };
+			std::uint32_t generation{ 0 };
+		};
+		thread_local LastFilter last;
+
+		const std::uint32_t generation = g_collisionFilterCache.generation.load(std::memory_order_acquire);
+		if (last.generation == generation && last.base == projectileBase) {
+			outFilter = last.filter;
+			return true;
+		}
+
+		{
+			std::shared_lock lock(g_collisionFilterCache.lock);
+			const auto it = g_collisionFilterCache.filters.find(projectileBase);
+			if (it != g_collisionFilterCache.filters.end()) {
+				outFilter = it->second;
+				last = { projectileBase, outFilter, generation };
+				return true;
+			}
+		}
+
+		if (!ComputeCollisionFilter(projectileBase, outFilter)) {
+			return false;
+		}
+
+		{
+			std::unique_lock lock(g_collisionFilterCache.lock);
+			if (g_collisionFilterCache.generation.load(std::memory_order_relaxed) == generation) {
+				g_collisionFilterCache.filters.emplace(projectileBase, outFilter);
 			}
 		}
 
-		*reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::uintptr_t>(&pickData) + 0x0C) = (collisionGroup << 16);
+		last = { projectileBase, outFilter, generation };
+		return true;
+	}
+
+	// Collision layer of the body a ray hit; the layer is the low 7 bits of its filter info.
+	std::uint32_t HitLayer(const RE::hknpCollisionResult& result) noexcept
+	{
+		return result.hitBodyInfo.shapeCollisionFilterInfo & 0x7F;
+	}
+
+	constexpr std::size_t kScratchBytes = 32 * 1024;
+	constexpr std::uintptr_t kPickCollectorOffset = 0xD0;
+
+	struct ScratchArena
+	{
+		alignas(std::max_align_t) std::array<std::byte, kScratchBytes> buffer;
+		std::pmr::monotonic_buffer_resource resource{ buffer.data(), buffer.size(), Penetration::Memory::Resource(Penetration::Memory::Tag::kRaycasts) };
+	};
+
+	ScratchArena& GetScratchArena() noexcept
+	{
+		thread_local ScratchArena arena;
+		return arena;
+	}
+
+	struct CollectorDeleter
+	{
+		void operator()(RE::hknpAllHitsCollector* collector) const noexcept
+		{
+			Penetration::Memory::RecordDeallocation(Penetration::Memory::Tag::kRaycasts, sizeof(RE::hknpAllHitsCollector));
+			delete collector;
+		}
+	};
+
+	// One collector per thread, freed when the thread exits (worker pool restarts join their
+	// threads); PerformRaycast resets it before every cast.
+	RE::hknpAllHitsCollector* GetThreadCollector()
+	{
+		thread_local std::unique_ptr<RE::hknpAllHitsCollector, CollectorDeleter> collector = []() {
+			Penetration::Memory::RecordAllocation(Penetration::Memory::Tag::kRaycasts, sizeof(RE::hknpAllHitsCollector));
+			return std::unique_ptr<RE::hknpAllHitsCollector, CollectorDeleter>(new RE::hknpAllHitsCollector());
+		}();
+		return collector.get();
+	}
+
+	void ConfigurePickFilter(RE::bhkPickData& pickData, const Utils::PickFilter& filter)
+	{
+		if (filter.hasCollisionFilter) {
+			*reinterpret_cast<std::uint64_t*>(reinterpret_cast<std::uintptr_t>(&pickData) + 0xC8) = filter.collisionFilter;
+		}
+
+		*reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::uintptr_t>(&pickData) + 0x0C) = (filter.collisionGroup << 16);
 	}
 }
 
 namespace Utils
 {
-	std::string Trim(std::string_view value)
+	std::string_view TrimView(std::string_view value) noexcept
 	{
-		const auto begin = std::find_if_not(value.begin(), value.end(), [](unsigned char ch) { return std::isspace(ch) != 0; });
-		const auto end = std::find_if_not(value.rbegin(), value.rend(), [](unsigned char ch) { return std::isspace(ch) != 0; }).base();
-		if (begin >= end) {
-			return {};
+		const auto isSpace = [](unsigned char ch) { return std::isspace(ch) != 0; };
+		while (!value.empty() && isSpace(value.front())) {
+			value.remove_prefix(1);
+		}
+		while (!value.empty() && isSpace(value.back())) {
+			value.remove_suffix(1);
 		}
-		return std::string(begin, end);
+		return value;
 	}
 
-	std::string SplitString(const std::string& str, const std::string& delimiter, std::string& remainder)
+	bool SplitOnce(std::string_view value, char delimiter, std::string_view& outHead, std::string_view& outTail) noexcept
 	{
-		const auto pos = str.find(delimiter);
-		if (pos == std::string::npos) {
-			remainder.clear();
-			return str;
+		const auto pos = value.find(delimiter);
+		if (pos == std::string_view::npos) {
+			return false;
 		}
 
-		remainder = str.substr(pos + delimiter.size());
-		return str.substr(0, pos);
+		outHead = TrimView(value.substr(0, pos));
+		outTail = TrimView(value.substr(pos + 1));
+		return true;
+	}
+
+	bool IEquals(std::string_view lhs, std::string_view rhs) noexcept
+	{
+		return lhs.size() == rhs.size() &&
+		       std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](unsigned char left, unsigned char right) {
+				   return std::tolower(left) == std::tolower(right);
+			   });
+	}
+
+	bool ParseHex(std::string_view value, std::uint32_t& outValue) noexcept
+	{
+		value = TrimView(value);
+		if (value.size() > 2 && value[0] == '0' && (value[1] == 'x' || value[1] == 'X')) {
+			value.remove_prefix(2);
+		}
+		if (value.empty()) {
+			return false;
+		}
+
+		const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), outValue, 16);
+		return ec == std::errc{} && ptr == value.data() + value.size();
+	}
+
+	bool ParseUInt(std::string_view value, std::uint32_t& outValue) noexcept
+	{
+		value = TrimView(value);
+		if (value.empty()) {
+			return false;
+		}
+
+		const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), outValue);
+		return ec == std::errc{} && ptr == value.data() + value.size();
+	}
+
+	bool ParseFloat(std::string_view value, float& outValue) noexcept
+	{
+		value = TrimView(value);
+		if (!value.empty() && value.front() == '+') {
+			value.remove_prefix(1);
+		}
+		if (value.empty()) {
+			return false;
+		}
+
+		float parsed = 0.0f;
+		const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+		if (ec != std::errc{} || ptr != value.data() + value.size() || !std::isfinite(parsed)) {
+			return false;
+		}
+
+		outValue = parsed;
+		return true;
 	}
 
 	RE::Actor* ResolveActor(const RE::ObjectRefHandle& handle) noexcept
@@ -94,17 +256,64 @@ namespace Utils
 		return nullptr;
 	}
 
+	bool IsStaticGeometry(std::uint32_t layer) noexcept
+	{
+		constexpr std::uint32_t kStatic = 1;
+		constexpr std::uint32_t kAnimStatic = 2;
+		constexpr std::uint32_t kTrees = 9;
+		constexpr std::uint32_t kTerrain = 13;
+		constexpr std::uint32_t kGround = 17;
+
+		switch (layer) {
+		case kStatic:
+		case kAnimStatic:
+		case kTrees:
+		case kTerrain:
+		case kGround:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	PickFilter ResolvePickFilter(RE::Actor* shooter, RE::BGSProjectile* projectileBase, bool excludeShooter)
+	{
+		PickFilter filter;
+		filter.hasCollisionFilter = GetCollisionFilter(projectileBase, filter.collisionFilter);
+
+		if (excludeShooter && shooter && shooter->loadedData) {
+			auto* loadedFlag = reinterpret_cast<std::uint8_t*>(shooter->loadedData) + 0x20;
+			if ((*loadedFlag & 0x1) != 0) {
+				filter.collisionGroup = shooter->GetCurrentCollisionGroup();
+			}
+		}
+		return filter;
+	}
+
+	std::pmr::memory_resource* ScratchResource() noexcept
+	{
+		return std::addressof(GetScratchArena().resource);
+	}
+
+	void ResetScratch() noexcept
+	{
+		GetScratchArena().resource.release();
+	}
+
+	PickScope::~PickScope()
+	{
+		data.Reset();
+		*reinterpret_cast<std::uintptr_t*>(reinterpret_cast<std::uintptr_t>(&data) + kPickCollectorOffset) = 0;
+	}
+
 	bool PerformRaycast(
-		RE::Projectile& projectile,
-		RE::Actor* shooter,
-		RE::BGSProjectile* projectileBase,
+		RE::TESObjectCELL* cell,
+		const PickFilter& filter,
 		const RE::NiPoint3& start,
 		const RE::NiPoint3& end,
 		RE::bhkPickData& pickData,
-		RaycastHit& outHit,
-		bool excludeShooter)
+		RaycastHit& outHit)
 	{
-		auto* cell = projectile.parentCell;
 		if (!cell) {
 			return false;
 		}
@@ -122,15 +331,15 @@ namespace Utils
 		pickData.Reset();
 		pickData.SetStartEnd(start, end);
 
-		if (auto* collector = new RE::hknpAllHitsCollector()) {
-			*reinterpret_cast<std::uintptr_t*>(reinterpret_cast<std::uintptr_t>(&pickData) + 0xD0) = reinterpret_cast<std::uintptr_t>(collector);
+		if (auto* collector = GetThreadCollector()) {
+			*reinterpret_cast<std::uintptr_t*>(reinterpret_cast<std::uintptr_t>(&pickData) + kPickCollectorOffset) = reinterpret_cast<std::uintptr_t>(collector);
 			*reinterpret_cast<std::uint32_t*>(reinterpret_cast<std::uintptr_t>(&pickData) + 0xD8) = 0;
 			collector->Reset();
 		} else {
 			logger::warn("[Penetration] Failed to allocate all-hits collector; penetration raycasts limited to closest hit");
 		}
 
-		ConfigurePickFilter(pickData, shooter, projectileBase, excludeShooter);
+		ConfigurePickFilter(pickData, filter);
 
 		if (!cell->Pick(pickData)) {
 			return false;
@@ -146,6 +355,7 @@ namespace Utils
 
 		outHit.point = RE::NiPoint3(hitPosition.x, hitPosition.y, hitPosition.z) / worldScale;
 		outHit.normal = RE::NiPoint3(hitNormal.x, hitNormal.y, hitNormal.z);
+		outHit.layer = HitLayer(pickData.result);
 
 		return true;
 	}
@@ -173,6 +383,7 @@ namespace Utils
 			if (distanceSq >= 2.25f) {
 				outHit.point = point;
 				outHit.normal = RE::NiPoint3(temp.normal.x, temp.normal.y, temp.normal.z);
+				outHit.layer = HitLayer(temp);
 				found = true;
 				break;
 			}
@@ -181,6 +392,41 @@ namespace Utils
 		return found;
 	}
 
+	void GatherHits(RE::bhkPickData& pickData, const RE::NiPoint3& origin, std::pmr::vector<RaycastHit>& outHits)
+	{
+		outHits.clear();
+
+		const std::int32_t hitCount = pickData.GetAllCollectorRayHitSize();
+		if (hitCount <= 0) {
+			return;
+		}
+
+		const float worldScale = g_ptrBS2HkScale.address() != 0 ? *g_ptrBS2HkScale : 1.0f;
+		RE::hknpCollisionResult temp{};
+		outHits.reserve(static_cast<std::size_t>(hitCount));
+
+		for (std::int32_t index = 0; index < hitCount; ++index) {
+			if (!pickData.GetAllCollectorRayHitAt(static_cast<std::uint32_t>(index), temp)) {
+				continue;
+			}
+
+			RE::NiPoint3 point(temp.position.x, temp.position.y, temp.position.z);
+			point /= worldScale;
+			outHits.push_back({ point, RE::NiPoint3(temp.normal.x, temp.normal.y, temp.normal.z), HitLayer(temp) });
+		}
+
+		std::sort(outHits.begin(), outHits.end(), [&](const RaycastHit& lhs, const RaycastHit& rhs) {
+			return origin.GetSquaredDistance(lhs.point) < origin.GetSquaredDistance(rhs.point);
+		});
+	}
+
+	void InvalidateCollisionFilterCache()
+	{
+		std::unique_lock lock(g_collisionFilterCache.lock);
+		g_collisionFilterCache.filters.clear();
+		g_collisionFilterCache.generation.fetch_add(1, std::memory_order_acq_rel);
+	}
+
 	RE::ProjectileHandle Launch(const RE::ProjectileLaunchData& data)
 	{
 		using func_t = decltype(&Utils::Launch);
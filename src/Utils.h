@@ -1,7 +1,9 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
+#include <memory_resource>
 #include <string_view>
+#include <vector>
 
 #include <RE/Bethesda/BSPointerHandle.h>
 #include <RE/Bethesda/Projectiles.h>
@@ -10,8 +12,17 @@
 
 namespace Utils
 {
-	std::string Trim(std::string_view value);
-	std::string SplitString(const std::string& str, const std::string& delimiter, std::string& remainder);
+	// Non-allocating helpers for config text. Returned views alias the input.
+	std::string_view TrimView(std::string_view value) noexcept;
+	// Splits at the first `delimiter` and trims both halves; false when the delimiter is absent.
+	bool SplitOnce(std::string_view value, char delimiter, std::string_view& outHead, std::string_view& outTail) noexcept;
+	bool IEquals(std::string_view lhs, std::string_view rhs) noexcept;
+
+	// Whole-string parsers; surrounding whitespace is ignored and `outValue` is left untouched on
+	// failure. ParseHex accepts an optional 0x prefix.
+	bool ParseHex(std::string_view value, std::uint32_t& outValue) noexcept;
+	bool ParseUInt(std::string_view value, std::uint32_t& outValue) noexcept;
+	bool ParseFloat(std::string_view value, float& outValue) noexcept;
 
 	RE::Actor* ResolveActor(const RE::ObjectRefHandle& handle) noexcept;
 
@@ -19,18 +30,55 @@ namespace Utils
 	{
 		RE::NiPoint3 point;
 		RE::NiPoint3 normal;
+		std::uint32_t layer{ 0 };
+	};
+
+	// True for collision layers of fixed world geometry (statics, terrain, trees). Characters,
+	// clutter and anything else that reacts to a hit are not.
+	bool IsStaticGeometry(std::uint32_t layer) noexcept;
+
+	// Per-thread bump arena for raycast temporaries. Memory handed out stays valid until the next
+	// ResetScratch on the same thread; only a request larger than the arena reaches the heap.
+	std::pmr::memory_resource* ScratchResource() noexcept;
+	void ResetScratch() noexcept;
+
+	// bhkPickData that borrows this thread's all-hits collector for PerformRaycast. The collector
+	// is reused across casts and detached again on destruction, so the pick never owns it.
+	class PickScope
+	{
+	public:
+		PickScope() = default;
+		PickScope(const PickScope&) = delete;
+		PickScope& operator=(const PickScope&) = delete;
+		~PickScope();
+
+		RE::bhkPickData& get() noexcept { return data; }
+
+	private:
+		RE::bhkPickData data;
+	};
+
+	// Collision filter of the projectile base and collision group of the shooter for a pick.
+	// Resolved on the game thread; PerformRaycast then reads no game objects besides the cell.
+	struct PickFilter
+	{
+		std::uint64_t collisionFilter{ 0 };
+		std::uint32_t collisionGroup{ 6 };
+		bool hasCollisionFilter{ false };
 	};
 
+	PickFilter ResolvePickFilter(RE::Actor* shooter, RE::BGSProjectile* projectileBase, bool excludeShooter = true);
+
 	bool PerformRaycast(
-		RE::Projectile& projectile,
-		RE::Actor* shooter,
-		RE::BGSProjectile* projectileBase,
+		RE::TESObjectCELL* cell,
+		const PickFilter& filter,
 		const RE::NiPoint3& start,
 		const RE::NiPoint3& end,
 		RE::bhkPickData& pickData,
-		RaycastHit& outHit,
-		bool excludeShooter = true);
+		RaycastHit& outHit);
 
 	bool SelectRealExit(RE::bhkPickData& pickData, const RE::NiPoint3& reference, RaycastHit& outHit);
+	void GatherHits(RE::bhkPickData& pickData, const RE::NiPoint3& origin, std::pmr::vector<RaycastHit>& outHits);
+	void InvalidateCollisionFilterCache();
 	RE::ProjectileHandle Launch(const RE::ProjectileLaunchData& data);
 }
@@ -0,0 +1,266 @@
+#include "WorkerPool.h"
+
+#include "MemoryTracking.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+namespace Penetration::Workers
+{
+	namespace
+	{
+		constexpr std::size_t kMaxQueued = 256;
+
+		// Each worker owns a deque. Submissions are dealt round-robin; a worker takes jobs from
+		// the front of its own deque (oldest first, so nothing outlives the latency tolerance
+		// while newer work is served) and steals from the back of the others when it runs dry.
+		struct WorkerQueue
+		{
+			Memory::Deque<Memory::Tag::kWorkers, Job> jobs;
+			std::mutex lock;
+		};
+
+		struct Pool
+		{
+			std::vector<std::unique_ptr<WorkerQueue>> queues;
+			std::vector<std::thread> threads;
+			std::atomic<std::uint32_t> next{ 0 };
+			std::atomic<std::size_t> pending{ 0 };
+			bool deterministic{ false };
+
+			// Workers sleep until `generation` moves past the value they saw before their last
+			// search, so a failed search never spins on work another worker is about to take.
+			std::mutex sleepLock;
+			std::condition_variable wake;
+			std::uint64_t generation{ 0 };
+			bool stopping{ false };
+		};
+
+		struct Stats
+		{
+			std::atomic<std::uint64_t> submitted{ 0 };
+			std::atomic<std::uint64_t> rejected{ 0 };
+			std::atomic<std::uint64_t> stolen{ 0 };
+		};
+
+		// Game thread only. The running pool is deliberately leaked at process exit: its threads
+		// are never joined during teardown, where joining would hang.
+		Pool* g_pool{ nullptr };
+		Stats g_stats;
+
+		// Affinity masks of the physical cores other than the one the calling (game) thread is on;
+		// SMT siblings share a core's mask. Empty when the topology cannot be queried.
+		std::vector<GROUP_AFFINITY> OtherPhysicalCores()
+		{
+			DWORD length = 0;
+			if (GetLogicalProcessorInformationEx(RelationProcessorCore, nullptr, &length) || GetLastError() != ERROR_INSUFFICIENT_BUFFER) {
+				return {};
+			}
+
+			std::vector<std::byte> buffer(length);
+			if (!GetLogicalProcessorInformationEx(RelationProcessorCore, reinterpret_cast<PSYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX>(buffer.data()), &length)) {
+				return {};
+			}
+
+			PROCESSOR_NUMBER current{};
+			GetCurrentProcessorNumberEx(&current);
+
+			std::vector<GROUP_AFFINITY> cores;
+			for (DWORD offset = 0; offset < length;) {
+				const auto& info = *reinterpret_cast<const SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX*>(buffer.data() + offset);
+				offset += info.Size;
+				if (info.Relationship != RelationProcessorCore) {
+					continue;
+				}
+
+				// A core never spans processor groups, so its first mask is all of it.
+				const GROUP_AFFINITY& mask = info.Processor.GroupMask[0];
+				if (mask.Group == current.Group && (mask.Mask & (KAFFINITY{ 1 } << current.Number)) != 0) {
+					continue;
+				}
+				cores.push_back(mask);
+			}
+			return cores;
+		}
+
+		bool PopOwn(WorkerQueue& queue, Job& job)
+		{
+			std::scoped_lock lock(queue.lock);
+			if (queue.jobs.empty()) {
+				return false;
+			}
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			return true;
+		}
+
+		bool Steal(WorkerQueue& queue, Job& job, bool wait)
+		{
+			std::unique_lock lock(queue.lock, std::defer_lock);
+			if (wait) {
+				lock.lock();
+			} else if (!lock.try_lock()) {
+				return false;
+			}
+			if (queue.jobs.empty()) {
+				return false;
+			}
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			return true;
+		}
+
+		bool FindJob(Pool& pool, std::size_t self, Job& job)
+		{
+			if (PopOwn(*pool.queues[self], job)) {
+				return true;
+			}
+
+			// A contended queue is skipped on the first pass; the second pass only runs while
+			// work is known to be queued, and waits for the locks so no job is overlooked.
+			const std::size_t count = pool.queues.size();
+			for (const bool wait : { false, true }) {
+				if (wait && pool.pending.load(std::memory_order_acquire) == 0) {
+					break;
+				}
+				for (std::size_t offset = 1; offset < count; ++offset) {
+					if (Steal(*pool.queues[(self + offset) % count], job, wait)) {
+						g_stats.stolen.fetch_add(1, std::memory_order_relaxed);
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+
+		void WorkerMain(Pool& pool, std::size_t self)
+		{
+			for (;;) {
+				std::unique_lock lock(pool.sleepLock);
+				const std::uint64_t seen = pool.generation;
+				const bool stopping = pool.stopping;
+				lock.unlock();
+
+				Job job;
+				if (FindJob(pool, self, job)) {
+					pool.pending.fetch_sub(1, std::memory_order_acq_rel);
+					job();
+					continue;
+				}
+
+				// Queued jobs are drained before a stopping worker exits.
+				if (stopping) {
+					return;
+				}
+
+				lock.lock();
+				pool.wake.wait(lock, [&]() { return pool.generation != seen || pool.stopping; });
+			}
+		}
+	}
+
+	void Start(std::uint32_t count, bool deterministic)
+	{
+		const std::vector<GROUP_AFFINITY> cores = OtherPhysicalCores();
+		if (deterministic) {
+			count = 1;
+		} else if (count == 0) {
+			count = !cores.empty() ? static_cast<std::uint32_t>(cores.size()) : std::max(std::thread::hardware_concurrency(), 2u) - 1;
+		}
+
+		if (g_pool && g_pool->queues.size() == count && g_pool->deterministic == deterministic) {
+			return;
+		}
+		Stop();
+
+		auto pool = std::make_unique<Pool>();
+		pool->deterministic = deterministic;
+		pool->queues.reserve(count);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			pool->queues.push_back(std::make_unique<WorkerQueue>());
+		}
+		pool->threads.reserve(count);
+		for (std::uint32_t i = 0; i < count; ++i) {
+			auto& thread = pool->threads.emplace_back(WorkerMain, std::ref(*pool), i);
+			if (!cores.empty()) {
+				SetThreadGroupAffinity(thread.native_handle(), std::addressof(cores[i % cores.size()]), nullptr);
+			}
+		}
+		g_pool = pool.release();
+
+		logger::info(
+			FMT_STRING("[Penetration] Started {} penetration worker threads on {} other physical cores{}"),
+			count,
+			cores.size(),
+			deterministic ? " (deterministic)" : "");
+	}
+
+	void Stop()
+	{
+		if (!g_pool) {
+			return;
+		}
+
+		const std::unique_ptr<Pool> pool(std::exchange(g_pool, nullptr));
+		{
+			std::scoped_lock lock(pool->sleepLock);
+			pool->stopping = true;
+		}
+		pool->wake.notify_all();
+		for (auto& thread : pool->threads) {
+			thread.join();
+		}
+
+		logger::info(FMT_STRING("[Penetration] Stopped {} penetration worker threads"), pool->threads.size());
+	}
+
+	bool Submit(Job job)
+	{
+		if (!g_pool) {
+			return false;
+		}
+
+		auto& pool = *g_pool;
+		if (pool.pending.fetch_add(1, std::memory_order_acq_rel) >= kMaxQueued) {
+			pool.pending.fetch_sub(1, std::memory_order_acq_rel);
+			g_stats.rejected.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		const std::size_t threads = pool.queues.size();
+		auto& queue = *pool.queues[pool.next.fetch_add(1, std::memory_order_relaxed) % threads];
+		{
+			std::scoped_lock lock(queue.lock);
+			queue.jobs.push_back(std::move(job));
+		}
+
+		g_stats.submitted.fetch_add(1, std::memory_order_relaxed);
+		{
+			std::scoped_lock lock(pool.sleepLock);
+			++pool.generation;
+		}
+		pool.wake.notify_one();
+		return true;
+	}
+
+	void LogStats()
+	{
+		logger::info(
+			FMT_STRING("[Penetration] Workers: {} threads, {} jobs submitted, {} stolen, {} rejected"),
+			g_pool ? g_pool->threads.size() : 0,
+			g_stats.submitted.load(std::memory_order_relaxed),
+			g_stats.stolen.load(std::memory_order_relaxed),
+			g_stats.rejected.load(std::memory_order_relaxed));
+	}
+}
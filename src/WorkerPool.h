@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace Penetration::Workers
+{
+	using Job = std::function<void()>;
+
+	// Starts `count` background threads; 0 picks one per physical core other than the one the
+	// calling game thread runs on. Workers are pinned to those cores, round-robin, so they stay off
+	// the game thread's core. `deterministic` runs a single worker that executes jobs strictly in
+	// submission order; the scheduler pairs it with frame-counted latency and no budget deferral.
+	// Calling Start with the same configuration is a no-op; a different one stops the running pool
+	// first. Game thread only.
+	void Start(std::uint32_t count, bool deterministic);
+	// Runs the queued jobs to completion and joins the threads. Game thread only.
+	void Stop();
+
+	// Returns false when the pool is not running or its queue is full; the caller then runs the
+	// work itself.
+	bool Submit(Job job);
+
+	void LogStats();
+}
@@ -61,12 +61,14 @@ extern "C" DLLEXPORT bool F4SEAPI F4SEPlugin_Load(const F4SE::LoadInterface* a_f
 		case F4SE::MessagingInterface::kGameDataReady:
 			Hooks::InitializeHooks();
 			Penetration::LoadConfig();
+			Penetration::ResetCaches();
 			break;
 		case F4SE::MessagingInterface::kGameLoaded:
 		case F4SE::MessagingInterface::kPostLoadGame:
 		case F4SE::MessagingInterface::kNewGame:
 			Penetration::LoadConfig();
 			Penetration::ClearPendingQueue();
+			Penetration::ResetCaches();
 			break;
 		default:
 			break;